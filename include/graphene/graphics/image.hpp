@@ -54,6 +54,32 @@ public:
      * @brief フォーマットの取得
      */
     virtual PixelFormat Format(void) const = 0;
+
+    /**
+     * @brief ミップレベル数の取得
+     *
+     * 全ミップレベルは1つの領域に格納され、
+     * レベルnの各軸長はmax(1, Length(axis) >> n)になります。
+     */
+    virtual std::size_t Levels(void) const {
+        return 1;
+    }
+
+    /**
+     * @brief ミップレベル位置の取得
+     *
+     * Data()を起点としたミップレベルの先頭位置(bytes)を取得します。
+     */
+    virtual std::size_t LevelOffset(std::size_t level) const {
+        return 0;
+    }
+
+    /**
+     * @brief ミップレベル行間隔の取得
+     */
+    virtual std::size_t LevelStride(std::size_t level) const {
+        return Stride();
+    }
 };
 
 /**
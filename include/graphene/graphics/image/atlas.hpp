@@ -0,0 +1,114 @@
+/** @file
+ * @brief アトラス画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_ATLAS_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_ATLAS_HPP
+
+#include <vector>
+#include <graphene/graphics/image.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief アトラス領域構造体
+ */
+struct AtlasRegion {
+    std::size_t X;      ///< 左端(pixels)
+    std::size_t Y;      ///< 上端(pixels)
+    std::size_t Width;  ///< 横幅(pixels)
+    std::size_t Height; ///< 縦幅(pixels)
+    float       U0;     ///< 左端のテクスチャ座標
+    float       V0;     ///< 上端のテクスチャ座標
+    float       U1;     ///< 右端のテクスチャ座標
+    float       V1;     ///< 下端のテクスチャ座標
+};
+
+/**
+ * @brief アトラスインタフェース
+ *
+ * 複数の画像を1枚に詰め込んだ画像を扱うためのインタフェースです。 @n
+ * 画像の配置にはMaxRects法を使用します。
+ */
+class ImageAtlas : public Image {
+public:
+    /**
+     * @brief 画像の追加
+     *
+     * 空き領域に画像を配置します。 @n
+     * 成功した場合、領域はCount() - 1番目に追加されます。 @n
+     * 追加後のピクセルデータをテクスチャに反映するには再生成が必要です。
+     *
+     * @param [in] image 追加する画像
+     * @retval true  成功
+     * @retval false 空き領域不足
+     * @throw std::invalid_argument 未対応の画像
+     */
+    virtual bool Insert(const SharedImage image) = 0;
+
+    /**
+     * @brief 領域数の取得
+     */
+    virtual std::size_t Count(void) const = 0;
+
+    /**
+     * @brief 領域の取得
+     *
+     * @param [in] index 追加した順番
+     * @return アトラス領域
+     */
+    virtual const AtlasRegion& Region(std::size_t index) const = 0;
+
+    /**
+     * @brief 充填率の取得
+     *
+     * 画像全体に対する配置済み画像の面積比を取得します。
+     */
+    virtual double Efficiency(void) const = 0;
+};
+
+/**
+ * @brief ImageAtlasの共有ポインタ
+ */
+using SharedAtlas = std::shared_ptr<ImageAtlas>;
+
+/**
+ * @brief 空のアトラスの生成
+ *
+ * 実行時に画像を追加していくためのアトラスを生成します。 @n
+ * 各画像の間にはpadding分の隙間を空け、周囲にはextrude分だけ
+ * 縁のピクセルを引き伸ばして書き込みます。
+ *
+ * @param [in] format  ピクセルフォーマット
+ * @param [in] width   横幅
+ * @param [in] height  縦幅
+ * @param [in] padding 画像間の隙間(pixels)
+ * @param [in] extrude 縁の引き伸ばし幅(pixels)
+ * @return アトラスオブジェクト
+ * @throw std::invalid_argument 未対応のフォーマット
+ */
+SharedAtlas CreateImageAtlas(PixelFormat format, std::size_t width, std::size_t height, std::size_t padding, std::size_t extrude);
+
+/**
+ * @brief アトラスの構築
+ *
+ * 画像を面積の大きい順に配置し、全てが収まる最小の2の累乗サイズのアトラスを構築します。 @n
+ * 領域は引数の画像と同じ順番に並びます。
+ *
+ * @param [in] images  配置する画像
+ * @param [in] format  ピクセルフォーマット
+ * @param [in] maxSize 最大の一辺の長さ
+ * @param [in] padding 画像間の隙間(pixels)
+ * @param [in] extrude 縁の引き伸ばし幅(pixels)
+ * @return アトラスオブジェクト
+ * @throw std::invalid_argument 未対応のフォーマットまたは画像
+ * @throw std::length_error     最大サイズに収まらない
+ */
+SharedAtlas BuildImageAtlas(const std::vector<SharedImage>& images, PixelFormat format, std::size_t maxSize, std::size_t padding, std::size_t extrude);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_ATLAS_HPP
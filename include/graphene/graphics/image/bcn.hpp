@@ -0,0 +1,45 @@
+/** @file
+ * @brief BCn圧縮画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_BCN_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_BCN_HPP
+
+#include <graphene/graphics/image.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief 圧縮品質列挙型
+ */
+enum CompressQuality {
+    CompressQualityFast, ///< 速度優先
+    CompressQualityHigh  ///< 品質優先
+};
+
+/**
+ * @brief BCn形式への圧縮
+ *
+ * 画像をブロック圧縮形式に変換します。 @n
+ * formatにはBC1UNORM,BC3UNORM,BC4UNORM,BC5UNORM,BC7UNORMのいずれかを指定します。 @n
+ * 入力画像はRGBA8888に変換してから圧縮するため、
+ * 変換可能な任意のピクセルフォーマットを受け付けます。 @n
+ * 4x4ブロック行単位で複数のスレッドに分割して処理します。 @n
+ * 画像の端で4x4に満たないブロックは端のピクセルで補完されます。 @n
+ * 出力画像の横幅と縦幅は4の倍数に切り上げられます(D3D11はブロック圧縮テクスチャの最上位レベルに4の倍数を要求します)。 @n
+ * BC1では不透明度が50%未満のピクセルを透明として扱います。
+ *
+ * @param [in] image   入力画像
+ * @param [in] format  出力ピクセルフォーマット
+ * @param [in] quality 圧縮品質
+ * @return イメージオブジェクト
+ * @throw std::invalid_argument 未対応の入力画像または出力形式
+ */
+SharedImage EncodeImageBCn(const SharedImage image, PixelFormat format, CompressQuality quality);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_BCN_HPP
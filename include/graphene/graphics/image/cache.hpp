@@ -0,0 +1,89 @@
+/** @file
+ * @brief 画像キャッシュ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_CACHE_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_CACHE_HPP
+
+#include <functional>
+#include <graphene/graphics/image.hpp>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief 画像読み込み関数
+ *
+ * LoadImagePNGなどと同じ形式の関数です。
+ */
+using ImageLoader = std::function<SharedImage(Stream::SharedStream stream, PixelFormat format, bool burnAlpha)>;
+
+/**
+ * @brief 画像キャッシュインタフェース
+ *
+ * デコード済みの画像を共有するためのインタフェースです。 @n
+ * 同じ(ファクトリ,パス,フォーマット,アルファ焼き込み)の画像は、
+ * どこかで保持されている限り同じオブジェクトを返します。 @n
+ * 解放された画像も予算の範囲内で最近使用された順に保持します。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class ImageCache {
+public:
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~ImageCache() {}
+
+    /**
+     * @brief 画像の読み込み
+     *
+     * キャッシュにない場合はファクトリからパスを読み込みモードで開いてデコードします。 @n
+     * 同じ画像を同時に要求した場合、デコードは1回だけ行われ全員が結果を共有します。
+     *
+     * @param [in] factory   ストリームファクトリ
+     * @param [in] path      ストリーム識別文字列
+     * @param [in] format    ピクセルフォーマット
+     * @param [in] burnAlpha アルファを焼き込む
+     * @return イメージオブジェクト
+     * @throw std::exception 読み込み失敗
+     */
+    virtual SharedImage Load(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha) = 0;
+
+    /**
+     * @brief 保持サイズの取得
+     *
+     * 予算の対象として保持している画像の合計サイズ(bytes)を取得します。
+     */
+    virtual std::size_t Size(void) const = 0;
+
+    /**
+     * @brief キャッシュの破棄
+     *
+     * 保持している画像を全て解放します。 @n
+     * 使用中の画像には影響しません。
+     *
+     * @return なし
+     */
+    virtual void Clear(void) = 0;
+};
+
+/**
+ * @brief ImageCacheの共有ポインタ
+ */
+using SharedImageCache = std::shared_ptr<ImageCache>;
+
+/**
+ * @brief 画像キャッシュの生成
+ *
+ * @param [in] loader 画像読み込み関数
+ * @param [in] budget 解放後も保持する画像の合計サイズの上限(bytes)
+ * @return 画像キャッシュオブジェクト
+ */
+SharedImageCache CreateImageCache(ImageLoader loader, std::size_t budget);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_CACHE_HPP
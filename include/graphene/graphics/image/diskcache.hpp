@@ -0,0 +1,94 @@
+/** @file
+ * @brief 画像ディスクキャッシュ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_DISKCACHE_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_DISKCACHE_HPP
+
+#include <graphene/graphics/image/cache.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief キャッシュ検証方式列挙型
+ */
+enum CacheValidation {
+    CacheValidationTime, ///< パス,更新日時,サイズで識別(FileFactory以外から開いた場合は内容で識別)
+    CacheValidationHash  ///< 内容のハッシュ値で識別
+};
+
+/**
+ * @brief 画像ディスクキャッシュインタフェース
+ *
+ * 変換済みのピクセルデータをディレクトリにGTC形式で保存し、
+ * 次回以降はデコードと変換を行わずにメモリマップで読み込むためのインタフェースです。 @n
+ * キャッシュファイルは(ソースの識別値,フォーマット,アルファ焼き込み)から命名されるため、
+ * ソースが更新された場合は新しいファイルが作られ、古いファイルは容量超過時に削除されます。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class ImageDiskCache {
+public:
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~ImageDiskCache() {}
+
+    /**
+     * @brief 画像の読み込み
+     *
+     * キャッシュファイルがあればマップして返します。 @n
+     * ない場合はファクトリからパスを読み込みモードで開いてデコードし、キャッシュファイルを作成します。
+     *
+     * @param [in] factory   ストリームファクトリ
+     * @param [in] path      ストリーム識別文字列
+     * @param [in] format    ピクセルフォーマット
+     * @param [in] burnAlpha アルファを焼き込む
+     * @return イメージオブジェクト
+     * @throw std::exception 読み込み失敗
+     */
+    virtual SharedImage Load(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha) = 0;
+
+    /**
+     * @brief 使用容量の取得
+     *
+     * キャッシュファイルの合計サイズ(bytes)を取得します。
+     */
+    virtual std::size_t Size(void) const = 0;
+
+    /**
+     * @brief キャッシュの破棄
+     *
+     * キャッシュファイルを全て削除します。 @n
+     * マップ中の画像には影響しません。
+     *
+     * @return なし
+     */
+    virtual void Clear(void) = 0;
+};
+
+/**
+ * @brief ImageDiskCacheの共有ポインタ
+ */
+using SharedImageDiskCache = std::shared_ptr<ImageDiskCache>;
+
+/**
+ * @brief 画像ディスクキャッシュの生成
+ *
+ * ディレクトリが存在しない場合は作成します。 @n
+ * 使用容量が予算を超えた場合、最後に使用した日時が古いファイルから削除します。
+ *
+ * @param [in] loader     画像読み込み関数
+ * @param [in] directory  キャッシュディレクトリ
+ * @param [in] budget     使用容量の上限(bytes)
+ * @param [in] validation キャッシュ検証方式
+ * @return 画像ディスクキャッシュオブジェクト
+ * @throw std::filesystem::filesystem_error ディレクトリ作成失敗
+ */
+SharedImageDiskCache CreateImageDiskCache(ImageLoader loader, const std::string& directory, std::size_t budget, CacheValidation validation);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_DISKCACHE_HPP
@@ -0,0 +1,61 @@
+/** @file
+ * @brief GTCテクスチャコンテナ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_GTC_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_GTC_HPP
+
+#include <string>
+#include <graphene/graphics/image.hpp>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief GTC画像の読み込み
+ *
+ * GTC(Graphene Texture Container)形式の画像を読み込みます。 @n
+ * GTC形式は変換済みのピクセルデータをそのまま格納するため、
+ * 展開やピクセルフォーマットの変換は行われません。 @n
+ * ストリームがStream::MappedStreamを実装している場合はマップされた内容を直接参照し、
+ * それ以外の場合はストリームの内容をメモリにコピーします。
+ *
+ * @param [in] stream 入力ストリーム
+ * @return イメージオブジェクト
+ * @throw std::exception オブジェクト生成失敗
+ */
+SharedImage LoadImageGTC(Stream::SharedStream stream);
+
+/**
+ * @brief GTC画像のマップ
+ *
+ * GTC形式のファイルをメモリにマップして読み込みます。 @n
+ * 返されるイメージオブジェクトのデータはマップしたメモリを直接指すため、
+ * ピクセルデータはアクセスされた時点で必要な分だけ読み込まれます。
+ *
+ * @param [in] path ファイルパス
+ * @return イメージオブジェクト
+ * @throw std::exception オブジェクト生成失敗
+ */
+SharedImage MapImageGTC(const std::string& path);
+
+/**
+ * @brief GTC画像の保存
+ *
+ * 画像をGTC形式で保存します。 @n
+ * 画像が複数のミップレベルを持つ場合は全レベルを保存します。 @n
+ * 各行は4バイト境界に揃えた行間隔で格納されます。
+ *
+ * @param [in] stream 出力ストリーム
+ * @param [in] image  イメージオブジェクト
+ * @return なし
+ * @throw std::exception 保存失敗
+ */
+void SaveImageGTC(Stream::SharedStream stream, const SharedImage image);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_GTC_HPP
@@ -0,0 +1,70 @@
+/** @file
+ * @brief 遅延読み込み画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_LAZY_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_LAZY_HPP
+
+#include <graphene/graphics/image.hpp>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief 遅延読み込みイメージインタフェース
+ *
+ * 初めてピクセルデータが必要になった時点でデコードする画像のインタフェースです。 @n
+ * Rank,Length,Formatはファイルのヘッダのみを読み込んで返します。 @n
+ * Data,Size,Stride,Levels,LevelOffset,LevelStrideはデコード完了まで待機し、
+ * デコードに失敗した場合は例外を送出します。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class LazyImage : public Image {
+public:
+    /**
+     * @brief 先行読み込み
+     *
+     * 全ての画像で共有するワーカースレッド(ハードウェアの同時実行数)にデコードを要求します。 @n
+     * 多数の画像で呼び出した場合は要求した順にデコードされます。 @n
+     * デコードの開始前にピクセルデータが必要になった場合は、呼び出し元のスレッドでデコードします。 @n
+     * 既に開始している場合は何もしません。
+     *
+     * @return なし
+     */
+    virtual void Prefetch(void) = 0;
+
+    /**
+     * @brief デコード完了の確認
+     *
+     * @retval true  デコード完了
+     * @retval false 未デコードまたはデコード中
+     */
+    virtual bool Loaded(void) const = 0;
+};
+
+/**
+ * @brief LazyImageの共有ポインタ
+ */
+using SharedLazyImage = std::shared_ptr<LazyImage>;
+
+/**
+ * @brief 遅延読み込み画像の生成
+ *
+ * ソースと読み込み設定のみを記録し、ストリームは必要になるまで開きません。 @n
+ * 対応するソースはPNG(libpng使用時),QOI,GTCで、ヘッダから自動判別します。 @n
+ * GTCの場合はフォーマットとアルファの焼き込みは無視されます。
+ *
+ * @param [in] factory   ストリームファクトリ
+ * @param [in] path      ストリーム識別文字列
+ * @param [in] format    ピクセルフォーマット
+ * @param [in] burnAlpha アルファを焼き込む
+ * @return イメージオブジェクト
+ */
+SharedLazyImage CreateLazyImage(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_LAZY_HPP
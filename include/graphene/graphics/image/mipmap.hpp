@@ -0,0 +1,45 @@
+/** @file
+ * @brief ミップマップ生成
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_MIPMAP_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_MIPMAP_HPP
+
+#include <graphene/graphics/image.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief ミップマップフィルタ列挙型
+ */
+enum MipmapFilter {
+    MipmapFilterBox,   ///< ボックスフィルタ(2x2平均)
+    MipmapFilterKaiser ///< カイザー窓フィルタ(6タップ)
+};
+
+/**
+ * @brief ミップマップの生成
+ *
+ * 画像から1x1までの全ミップレベルを生成します。 @n
+ * 全レベルは1つの領域に格納され、
+ * 各レベルの位置と行間隔はImage::LevelOffset,Image::LevelStrideで取得できます。 @n
+ * 縮小は線形空間の浮動小数点数で行い、結果は入力と同じピクセルフォーマットで格納されます。 @n
+ * premultipliedがfalseの場合は色をアルファで重み付けして縮小するため、
+ * 透明なピクセルの色が不透明なピクセルに滲みません。 @n
+ * 大きなレベルは行単位で複数のスレッドに分割して処理します。
+ *
+ * @param [in] image         入力画像
+ * @param [in] filter        ミップマップフィルタ
+ * @param [in] gamma         色をsRGBとして扱いガンマ補正する
+ * @param [in] premultiplied アルファが焼き込み済み
+ * @return イメージオブジェクト
+ * @throw std::invalid_argument 未対応または空の入力画像
+ */
+SharedImage GenerateMipmaps(const SharedImage image, MipmapFilter filter, bool gamma, bool premultiplied);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_MIPMAP_HPP
@@ -0,0 +1,46 @@
+/** @file
+ * @brief QOI画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_QOI_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_QOI_HPP
+
+#include <graphene/graphics/image.hpp>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief QOI画像の読み込み
+ *
+ * QOI画像を読み込みます。 @n
+ * PNGに比べてファイルサイズは大きくなりますが高速に展開できます。
+ *
+ * @param [in] stream    入力ストリーム
+ * @param [in] format    ピクセルフォーマット
+ * @param [in] burnAlpha アルファを焼き込む
+ * @return イメージオブジェクト
+ * @throw std::exception オブジェクト生成失敗
+ */
+SharedImage LoadImageQOI(Stream::SharedStream stream, PixelFormat format, bool burnAlpha);
+
+/**
+ * @brief QOI画像の保存
+ *
+ * 画像をQOI形式で保存します。 @n
+ * 入力画像はRGBA8888に変換してから保存されます。 @n
+ * アルファを持たないピクセルフォーマットの場合は3チャンネルで保存されます。
+ *
+ * @param [in] stream 出力ストリーム
+ * @param [in] image  イメージオブジェクト
+ * @return なし
+ * @throw std::exception 保存失敗
+ */
+void SaveImageQOI(Stream::SharedStream stream, const SharedImage image);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_QOI_HPP
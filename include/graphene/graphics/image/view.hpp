@@ -0,0 +1,54 @@
+/** @file
+ * @brief 部分画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_IMAGE_VIEW_HPP
+#define GRAPHENE_GRAPHICS_IMAGE_VIEW_HPP
+
+#include <vector>
+#include <graphene/graphics/image.hpp>
+
+namespace Graphene::Graphics {
+
+/**
+ * @brief 部分画像の生成
+ *
+ * 画像の矩形領域を参照する部分画像を生成します。 @n
+ * ピクセルデータはコピーされず、部分画像は元画像を保持したまま
+ * 元画像の行間隔でデータを参照します。 @n
+ * ブロック圧縮形式の場合、矩形の位置は4の倍数である必要があります。 @n
+ * ミップレベルを持つ画像の場合は最上位レベルのみを参照します。 @n
+ * 3次元以上の画像(配列やボリューム)の場合は先頭の面のみを参照し、部分画像は2次元になります。
+ *
+ * @param [in] image  元画像
+ * @param [in] x      矩形の左端
+ * @param [in] y      矩形の上端
+ * @param [in] width  矩形の横幅
+ * @param [in] height 矩形の縦幅
+ * @return イメージオブジェクト
+ * @throw std::out_of_range     矩形が元画像からはみ出している
+ * @throw std::invalid_argument 未対応の元画像または矩形の位置
+ */
+SharedImage CreateImageView(const SharedImage image, std::size_t x, std::size_t y, std::size_t width, std::size_t height);
+
+/**
+ * @brief 格子状の分割
+ *
+ * 画像を指定したサイズの格子で分割した部分画像を生成します。 @n
+ * 部分画像は左上から右方向,下方向の順に並びます。 @n
+ * 右端と下端で指定したサイズに満たない領域は含まれません。
+ *
+ * @param [in] image  元画像
+ * @param [in] width  格子の横幅
+ * @param [in] height 格子の縦幅
+ * @return 部分画像の配列
+ * @throw std::invalid_argument 未対応の元画像または格子のサイズ
+ */
+std::vector<SharedImage> SliceImage(const SharedImage image, std::size_t width, std::size_t height);
+
+} // namespace Graphene::Graphics
+
+#endif // GRAPHENE_GRAPHICS_IMAGE_VIEW_HPP
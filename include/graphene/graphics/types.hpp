@@ -56,7 +56,12 @@ enum PixelFormat {
     RGBA5551, ///< 格納方式(UNORM,LE): GGBBBBBA RRRRRGGG (bin)
     BGRA5551, ///< 格納方式(UNORM,LE): GGRRRRRA BBBBBGGG (bin)
     RGBA5650, ///< 格納方式(UNORM,LE): GGGBBBBB RRRRRGGG (bin)
-    BGRA5650  ///< 格納方式(UNORM,LE): GGGRRRRR BBBBBGGG (bin)
+    BGRA5650, ///< 格納方式(UNORM,LE): GGGRRRRR BBBBBGGG (bin)
+    BC1UNORM, ///< 格納方式(UNORM,BC1): 4x4ブロック毎に8バイト
+    BC3UNORM, ///< 格納方式(UNORM,BC3): 4x4ブロック毎に16バイト
+    BC4UNORM, ///< 格納方式(UNORM,BC4): 4x4ブロック毎に8バイト(R)
+    BC5UNORM, ///< 格納方式(UNORM,BC5): 4x4ブロック毎に16バイト(RG)
+    BC7UNORM  ///< 格納方式(UNORM,BC7): 4x4ブロック毎に16バイト
 };
 
 } // namespace Graphene::Graphics
@@ -0,0 +1,120 @@
+/** @file
+ * @brief アーカイブ入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_ARCHIVE_HPP
+#define GRAPHENE_STREAM_ARCHIVE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief アーカイブエントリ構造体
+ */
+struct ArchiveEntry {
+    std::string Name;     ///< アーカイブ内の名前
+    std::string Path;     ///< 格納するストリームの識別文字列
+    bool        Compress; ///< CompressedStream形式で圧縮して格納する
+};
+
+/**
+ * @brief アーカイブファクトリクラス
+ *
+ * 1つのアーカイブファイル(GPK形式)に格納された複数のストリームを名前で開くためのファクトリクラスです。 @n
+ * 目次は名前順に整列されており、二分探索で検索します。 @n
+ * アーカイブがメモリにマップできる場合、各エントリはコピーなしで参照できるMappedStreamになります。 @n
+ * それ以外の場合、各エントリは元のストリームの範囲を切り出したストリームになり、
+ * 元のストリームのReadAtで読み込むため、複数のエントリを同時に読み込めます。 @n
+ * 圧縮して格納されたエントリは、シーク可能なCompressedStreamとして展開しながら読み込みます。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class ArchiveFactory final : public StreamFactory, public EnumerableFactory {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * アーカイブファイルをメモリにマップして開きます。
+     *
+     * @param [in] path アーカイブファイルのパス
+     * @throw std::system_error  ファイルマップ失敗
+     * @throw std::runtime_error 不正なアーカイブ
+     */
+    explicit ArchiveFactory(const std::string& path);
+
+    /**
+     * @brief コンストラクタ
+     *
+     * ストリームをアーカイブとして開きます。
+     *
+     * @param [in] stream アーカイブストリーム
+     * @throw std::runtime_error 不正なアーカイブ
+     */
+    explicit ArchiveFactory(SharedStream stream);
+
+    /**
+     * @brief エントリを開く
+     *
+     * 名前で指定したエントリを読み込み専用で開きます。 @n
+     * オープンモードは"r"のみをサポートしています。 @n
+     * "d"オプションを付けた場合("rd","rbd")は無視して"r"と同じく開きます。 @n
+     * エントリはアーカイブのストリームから読み込むため、ダイレクトI/Oで読み込むには
+     * FileFactoryから"rd"で開いたストリームでアーカイブを開きます。
+     *
+     * @param [in] path エントリ名
+     * @param [in] mode オープンモード
+     * @return Streamの共有ポインタ
+     * @throw std::invalid_argument 未対応のオープンモード
+     * @throw std::system_error     エントリが存在しない
+     */
+    virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+
+    /**
+     * @brief エントリ名の取得
+     *
+     * @return 名前順に整列されたエントリ名の一覧
+     */
+    virtual std::vector<std::string> Names(void) const override;
+
+private:
+    struct Entry {
+        std::string   Name;
+        std::size_t   Offset;
+        std::size_t   Size;
+        std::uint32_t Flags;
+    };
+
+    void Parse(void);
+
+private:
+    SharedStream                Stream_;
+    std::shared_ptr<const void> Owner_;
+    const std::byte*            Data_;
+    std::size_t                 Size_;
+    std::vector<Entry>          Entries_;
+};
+
+/**
+ * @brief アーカイブの作成
+ *
+ * 各エントリのストリームをファクトリから開いて読み込み、
+ * GPK形式のアーカイブとして書き込みます。 @n
+ * エントリは名前順に並べ替えられます。
+ *
+ * @param [in] stream  出力ストリーム
+ * @param [in] factory 入力ストリームファクトリ
+ * @param [in] entries 格納するエントリ
+ * @return なし
+ * @throw std::invalid_argument エントリ名の重複
+ * @throw std::exception        読み書き失敗
+ */
+void SaveArchive(SharedStream stream, SharedStreamFactory factory, std::vector<ArchiveEntry> entries);
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_ARCHIVE_HPP
@@ -0,0 +1,90 @@
+/** @file
+ * @brief 非同期入力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_ASYNC_HPP
+#define GRAPHENE_STREAM_ASYNC_HPP
+
+#include <future>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief ディスクリプタストリームインタフェース
+ *
+ * OSのファイルディスクリプタを持つストリームが実装する追加のインタフェースです。 @n
+ * 対応しているかはdynamic_castで確認します。 @n
+ * ディスクリプタへの直接の読み込みは、ストリームのバッファに残っている未書き出しのデータを参照しません。
+ */
+class DescriptorStream {
+public:
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~DescriptorStream() {}
+
+    /**
+     * @brief ディスクリプタの取得
+     *
+     * @return ファイルディスクリプタ、閉じている場合は-1
+     */
+    virtual int Descriptor(void) const = 0;
+};
+
+/**
+ * @brief 非同期読み込みインタフェース
+ *
+ * ストリームの指定位置からの読み込みを非同期に行うためのインタフェースです。 @n
+ * 複数の読み込みを同時に要求し、デコードなどの処理と重ねて実行できます。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class AsyncReader {
+public:
+    /**
+     * @brief デストラクタ
+     *
+     * 実行中の読み込みが全て完了するまで待機します。
+     */
+    virtual ~AsyncReader() {}
+
+    /**
+     * @brief 読み込みの要求
+     *
+     * ストリームの先頭からoffsetの位置からsize分の読み込みを要求します。 @n
+     * 完了までストリームとdataは有効である必要があり、ストリームは完了まで保持されます。 @n
+     * 同時に要求できる数を超えた場合は空きができるまで待機します。
+     *
+     * @param [in]  stream 入力ストリーム
+     * @param [in]  offset ストリームの先頭からの位置(bytes)
+     * @param [out] data   読み込むデータを格納するポインタ
+     * @param [in]  size   読み込むサイズ(bytes)
+     * @return 実際に読み込まれたサイズ(bytes)を返すfuture、失敗した場合はstd::system_errorを送出
+     */
+    virtual std::future<std::size_t> Submit(SharedStream stream, std::size_t offset, void* data, std::size_t size) = 0;
+};
+
+/**
+ * @brief AsyncReaderの共有ポインタ
+ */
+using SharedAsyncReader = std::shared_ptr<AsyncReader>;
+
+/**
+ * @brief 非同期読み込みオブジェクトの生成
+ *
+ * Linuxでio_uringが使用可能な場合はio_uringで読み込みます。 @n
+ * それ以外の場合、またはDescriptorStreamを実装していないストリームは
+ * スレッドプールからStream::ReadAtで読み込みます。
+ *
+ * @param [in] depth 同時に実行できる読み込み数
+ * @return 非同期読み込みオブジェクト
+ * @throw std::invalid_argument depthが0
+ */
+SharedAsyncReader CreateAsyncReader(std::size_t depth);
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_ASYNC_HPP
@@ -0,0 +1,101 @@
+/** @file
+ * @brief バッファ付き入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_BUFFERED_HPP
+#define GRAPHENE_STREAM_BUFFERED_HPP
+
+#include <cstddef>
+#include <vector>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief バッファ付きストリームクラス
+ *
+ * 任意のストリームをラップし、小さな読み書きをまとめて元のストリームに渡すクラスです。 @n
+ * PNGのチャンクヘッダのように数バイトずつ読み込む処理で、
+ * 元のストリームの呼び出し回数を減らします。 @n
+ * バッファサイズ以上の読み書きはバッファを経由せずに元のストリームで直接行います。 @n
+ * 書き込んだデータはFlush,Seek,Read,Closeまたはオブジェクトの削除時に元のストリームへ書き出されます。
+ */
+class BufferedStream final : public Stream {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] stream 元のストリーム
+     * @param [in] size   バッファサイズ(bytes)
+     * @throw std::invalid_argument バッファサイズが0
+     */
+    explicit BufferedStream(SharedStream stream, std::size_t size = 64 * 1024);
+
+    /**
+     * @brief デストラクタ
+     *
+     * 書き込み待ちのデータを元のストリームへ書き出します。 @n
+     * 元のストリームは閉じません。
+     */
+    virtual ~BufferedStream() override;
+
+    virtual void Close(void) override;
+
+    virtual bool Flush(void) override;
+
+    virtual std::size_t Read(void* data, std::size_t size) override;
+
+    /**
+     * @brief ストリームのデータを参照
+     *
+     * バッファサイズ以下の場合はバッファを埋めてバッファ内のデータを参照します。 @n
+     * バッファサイズより大きい場合は空のデータを返します。
+     *
+     * @param [in] size 参照するサイズ(bytes)
+     * @return 参照できたデータ
+     */
+    virtual std::span<const std::byte> Peek(std::size_t size) override;
+
+    using Stream::Peek;
+
+    /**
+     * @brief ストリームの指定位置からデータを読み込む
+     *
+     * 元のストリームのReadAtで読み込み、書き込み待ちのデータと重なる範囲はバッファの内容で置き換えます。 @n
+     * バッファは変更しないため、複数のスレッドから同時に呼び出すことができます。
+     *
+     * @param [in]  offset ストリームの先頭からの位置(byte)
+     * @param [out] data   読み込むデータを格納するポインタ
+     * @param [in]  size   読み込むサイズ(byte)
+     * @return 実際に読み込まれたサイズ(byte)
+     */
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override;
+
+    virtual std::size_t Write(const void* data, std::size_t size) override;
+
+    virtual bool Seek(std::size_t offset) override;
+
+    virtual std::size_t Tell(void) const override;
+
+    virtual std::size_t Size(void) const override;
+
+    virtual bool Advise(AccessHint hint, std::size_t offset = 0, std::size_t size = 0) override;
+
+private:
+    bool FlushBuffer(void);
+
+private:
+    SharedStream           Stream_;
+    std::vector<std::byte> Buffer_;
+    std::size_t            Base_;     // バッファ先頭のストリーム上の位置
+    std::size_t            Fill_;     // バッファ内の有効なデータ量
+    std::size_t            Position_; // 論理的なストリームポインタの位置
+    bool                   Dirty_;    // バッファが書き込み待ちのデータを保持している
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_BUFFERED_HPP
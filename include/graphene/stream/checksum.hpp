@@ -0,0 +1,290 @@
+/** @file
+ * @brief チェックサム
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_CHECKSUM_HPP
+#define GRAPHENE_STREAM_CHECKSUM_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief XXH64ハッシュクラス
+ *
+ * データを分割して入力できるXXH64の実装です。 @n
+ * 暗号学的な強度はありませんが、キャッシュの識別やデータの破損の検出に使用できます。
+ */
+class XXH64 final {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] seed シード値
+     */
+    explicit XXH64(std::uint64_t seed = 0) :
+    Acc_   {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1},
+    Seed_  (seed),
+    Total_ (0),
+    Length_(0) {
+    }
+
+    /**
+     * @brief データの入力
+     *
+     * @param [in] data 入力データ
+     * @param [in] size 入力サイズ(bytes)
+     * @return なし
+     */
+    void Update(const void* data, std::size_t size) {
+        auto p   = static_cast<const std::uint8_t*>(data);
+        auto end = p + size;
+        Total_ += size;
+        if (Length_ + size < sizeof(Buffer_)) {
+            std::memcpy(Buffer_ + Length_, p, size);
+            Length_ += size;
+            return;
+        }
+        if (Length_) {
+            auto fill = sizeof(Buffer_) - Length_;
+            std::memcpy(Buffer_ + Length_, p, fill);
+            Consume(Buffer_);
+            p      += fill;
+            Length_ = 0;
+        }
+        // uint8_tのポインタとの別名の可能性を避けるため、ローカル変数で計算する
+        std::uint64_t acc[4] = {Acc_[0], Acc_[1], Acc_[2], Acc_[3]};
+        for (; end - p >= 32; p += 32) {
+            acc[0] = Round(acc[0], Load64(p));
+            acc[1] = Round(acc[1], Load64(p +  8));
+            acc[2] = Round(acc[2], Load64(p + 16));
+            acc[3] = Round(acc[3], Load64(p + 24));
+        }
+        std::memcpy(Acc_, acc, sizeof(Acc_));
+        std::memcpy(Buffer_, p, end - p);
+        Length_ = end - p;
+    }
+
+    /**
+     * @brief ハッシュ値の取得
+     *
+     * @return ここまでに入力したデータのハッシュ値
+     */
+    std::uint64_t Digest(void) const {
+        std::uint64_t h;
+        if (Total_ >= 32) {
+            h = Rotl(Acc_[0], 1) + Rotl(Acc_[1], 7) + Rotl(Acc_[2], 12) + Rotl(Acc_[3], 18);
+            for (auto acc : Acc_) h = (h ^ Round(0, acc)) * Prime1 + Prime4;
+        } else {
+            h = Seed_ + Prime5;
+        }
+        h += Total_;
+        auto p   = Buffer_;
+        auto end = Buffer_ + Length_;
+        for (; end - p >= 8; p += 8) h = Rotl(h ^ Round(0, Load64(p)), 27) * Prime1 + Prime4;
+        if (end - p >= 4) {
+            h  = Rotl(h ^ (Load32(p) * Prime1), 23) * Prime2 + Prime3;
+            p += 4;
+        }
+        for (; p < end; ++p) h = Rotl(h ^ (*p * Prime5), 11) * Prime1;
+        h ^= h >> 33;
+        h *= Prime2;
+        h ^= h >> 29;
+        h *= Prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /**
+     * @brief ハッシュ値の計算
+     *
+     * @param [in] data 入力データ
+     * @param [in] size 入力サイズ(bytes)
+     * @param [in] seed シード値
+     * @return ハッシュ値
+     */
+    static std::uint64_t Hash(const void* data, std::size_t size, std::uint64_t seed = 0) {
+        XXH64 hash(seed);
+        hash.Update(data, size);
+        return hash.Digest();
+    }
+
+private:
+    static constexpr std::uint64_t Prime1 = 0x9e3779b185ebca87ull;
+    static constexpr std::uint64_t Prime2 = 0xc2b2ae3d27d4eb4full;
+    static constexpr std::uint64_t Prime3 = 0x165667b19e3779f9ull;
+    static constexpr std::uint64_t Prime4 = 0x85ebca77c2b2ae63ull;
+    static constexpr std::uint64_t Prime5 = 0x27d4eb2f165667c5ull;
+
+    static std::uint64_t Rotl(std::uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static std::uint64_t Round(std::uint64_t acc, std::uint64_t input) {
+        return Rotl(acc + input * Prime2, 31) * Prime1;
+    }
+
+    static std::uint64_t Load64(const std::uint8_t* p) {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) {
+            v = (v & 0x00000000ffffffffull) << 32 | (v & 0xffffffff00000000ull) >> 32;
+            v = (v & 0x0000ffff0000ffffull) << 16 | (v & 0xffff0000ffff0000ull) >> 16;
+            v = (v & 0x00ff00ff00ff00ffull) <<  8 | (v & 0xff00ff00ff00ff00ull) >>  8;
+        }
+        return v;
+    }
+
+    static std::uint64_t Load32(const std::uint8_t* p) {
+        return static_cast<std::uint64_t>(p[0]) | p[1] << 8 | p[2] << 16 | static_cast<std::uint64_t>(p[3]) << 24;
+    }
+
+    void Consume(const std::uint8_t* p) {
+        for (int i = 0; i < 4; ++i) Acc_[i] = Round(Acc_[i], Load64(p + i * 8));
+    }
+
+private:
+    std::uint64_t Acc_[4];
+    std::uint64_t Seed_;
+    std::uint64_t Total_;
+    std::size_t   Length_;
+    std::uint8_t  Buffer_[32];
+};
+
+/**
+ * @brief CRC32Cクラス
+ *
+ * データを分割して入力できるCRC32C(Castagnoli)の実装です。 @n
+ * x86ではSSE4.2のcrc32命令、ARMではCRC32拡張命令が使用可能な場合に使用します。 @n
+ * SSE4.2の対応は実行時に判定します。
+ */
+class CRC32C final {
+public:
+    /**
+     * @brief コンストラクタ
+     */
+    CRC32C(void) :
+    State_(0xffffffff) {
+    }
+
+    /**
+     * @brief データの入力
+     *
+     * @param [in] data 入力データ
+     * @param [in] size 入力サイズ(bytes)
+     * @return なし
+     */
+    void Update(const void* data, std::size_t size);
+
+    /**
+     * @brief チェックサムの取得
+     *
+     * @return ここまでに入力したデータのチェックサム
+     */
+    std::uint32_t Digest(void) const {
+        return ~State_;
+    }
+
+    /**
+     * @brief チェックサムの計算
+     *
+     * @param [in] data 入力データ
+     * @param [in] size 入力サイズ(bytes)
+     * @return チェックサム
+     */
+    static std::uint32_t Hash(const void* data, std::size_t size) {
+        CRC32C crc;
+        crc.Update(data, size);
+        return crc.Digest();
+    }
+
+private:
+    std::uint32_t State_;
+};
+
+/**
+ * @brief チェックサムの種類
+ */
+enum ChecksumType {
+    ChecksumTypeCRC32C, ///< CRC32C
+    ChecksumTypeXXH64   ///< XXH64
+};
+
+/**
+ * @brief チェックサム付きストリームクラス
+ *
+ * 任意のストリームをラップし、Read,Writeで通過したデータのチェックサムを計算するクラスです。 @n
+ * 読み込みと書き込みのデータは通過した順番に1つのチェックサムとして計算されます。 @n
+ * Peekで参照したデータはConsumeで読み進めた時点でチェックサムに含まれます。 @n
+ * Seekはチェックサムに影響せず、ReadAtで読み込んだデータはチェックサムに含まれません。
+ */
+class ChecksumStream final : public Stream {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] stream 元のストリーム
+     * @param [in] type   チェックサムの種類
+     */
+    explicit ChecksumStream(SharedStream stream, ChecksumType type = ChecksumTypeCRC32C);
+
+    virtual void Close(void) override;
+
+    virtual bool Flush(void) override;
+
+    virtual std::size_t Read(void* data, std::size_t size) override;
+
+    virtual std::span<const std::byte> Peek(std::size_t size) override;
+
+    using Stream::Peek;
+
+    virtual std::size_t Consume(std::size_t size) override;
+
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override;
+
+    virtual std::size_t Write(const void* data, std::size_t size) override;
+
+    virtual bool Seek(std::size_t offset) override;
+
+    virtual std::size_t Tell(void) const override;
+
+    virtual std::size_t Size(void) const override;
+
+    virtual bool Advise(AccessHint hint, std::size_t offset = 0, std::size_t size = 0) override;
+
+    /**
+     * @brief チェックサムの取得
+     *
+     * CRC32Cの場合は下位32ビットに格納されます。
+     *
+     * @return ここまでに通過したデータのチェックサム
+     */
+    std::uint64_t Checksum(void) const;
+
+    /**
+     * @brief チェックサムの初期化
+     *
+     * @return なし
+     */
+    void ResetChecksum(void);
+
+private:
+    void Update(const void* data, std::size_t size);
+
+private:
+    SharedStream Stream_;
+    ChecksumType Type_;
+    CRC32C       CRC32C_;
+    XXH64        XXH64_;
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_CHECKSUM_HPP
@@ -0,0 +1,144 @@
+/** @file
+ * @brief 圧縮入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_COMPRESS_HPP
+#define GRAPHENE_STREAM_COMPRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief 圧縮後の最大サイズの取得
+ *
+ * @param [in] size 圧縮前のサイズ(bytes)
+ * @return CompressBlockの出力に必要な最大サイズ(bytes)
+ */
+std::size_t CompressBound(std::size_t size);
+
+/**
+ * @brief ブロックの圧縮
+ *
+ * LZ4ブロック形式でデータを圧縮します。
+ *
+ * @param [out] dst      出力先
+ * @param [in]  capacity 出力先のサイズ(bytes)
+ * @param [in]  src      入力データ
+ * @param [in]  size     入力サイズ(bytes)
+ * @return 圧縮後のサイズ(bytes)、出力先に収まらない場合は0
+ */
+std::size_t CompressBlock(void* dst, std::size_t capacity, const void* src, std::size_t size);
+
+/**
+ * @brief ブロックの展開
+ *
+ * LZ4ブロック形式のデータを展開します。 @n
+ * 不正なデータに対しても出力先の範囲外には書き込みません。
+ *
+ * @param [out] dst      出力先
+ * @param [in]  capacity 出力先のサイズ(bytes)
+ * @param [in]  src      圧縮データ
+ * @param [in]  size     圧縮サイズ(bytes)
+ * @return 展開後のサイズ(bytes)
+ * @throw std::runtime_error 不正な圧縮データ
+ */
+std::size_t DecompressBlock(void* dst, std::size_t capacity, const void* src, std::size_t size);
+
+/**
+ * @brief 圧縮ストリームクラス
+ *
+ * 元のストリームにGLZ形式で圧縮したデータを読み書きするクラスです。 @n
+ * データは独立したブロック単位で圧縮され、末尾のブロック索引により
+ * 読み込み時は任意の位置へシークできます。 @n
+ * 書き込み時はシークできず、Closeまたはオブジェクトの削除時に索引が書き込まれます。 @n
+ * 圧縮しても小さくならないブロックは無圧縮で格納されます。
+ */
+class CompressedStream final : public Stream {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * 元のストリームの現在位置からGLZ形式のデータを読み書きします。 @n
+     * オープンモードは"r"と"w"をサポートしています。
+     *
+     * @param [in] stream    元のストリーム
+     * @param [in] mode      オープンモード
+     * @param [in] blockSize ブロックサイズ(bytes、書き込み時のみ使用)
+     * @throw std::invalid_argument 未対応のオープンモードまたはブロックサイズ
+     * @throw std::runtime_error    不正な圧縮データ
+     */
+    CompressedStream(SharedStream stream, const std::string& mode, std::size_t blockSize = 64 * 1024);
+
+    /**
+     * @brief デストラクタ
+     *
+     * 書き込み時は残りのブロックと索引を書き込みます。 @n
+     * 元のストリームは閉じません。
+     */
+    virtual ~CompressedStream() override;
+
+    virtual void Close(void) override;
+
+    virtual bool Flush(void) override;
+
+    virtual std::size_t Read(void* data, std::size_t size) override;
+
+    /**
+     * @brief ストリームの指定位置からデータを読み込む
+     *
+     * ブロックを呼び出しごとのバッファに展開するため、複数のスレッドから同時に呼び出すことができます。 @n
+     * 圧縮データは元のストリームのReadAtで読み込みます。
+     *
+     * @param [in]  offset ストリームの先頭からの位置(byte)
+     * @param [out] data   読み込むデータを格納するポインタ
+     * @param [in]  size   読み込むサイズ(byte)
+     * @return 実際に読み込まれたサイズ(byte)
+     */
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override;
+
+    virtual std::size_t Write(const void* data, std::size_t size) override;
+
+    virtual bool Seek(std::size_t offset) override;
+
+    virtual std::size_t Tell(void) const override;
+
+    virtual std::size_t Size(void) const override;
+
+private:
+    struct Block {
+        std::uint64_t Offset; // 先頭位置からの圧縮データの位置
+        std::uint32_t Size;   // 圧縮データのサイズ
+        bool          Raw;    // 無圧縮で格納
+    };
+
+    bool LoadBlock(std::size_t index);
+    bool DecodeBlock(std::size_t index, std::byte* data, std::vector<std::byte>& packed) const;
+    bool StoreBlock(void);
+
+private:
+    SharedStream               Stream_;
+    std::span<const std::byte> Mapping_;   // 元のストリームがマップ済みの場合の内容
+    std::size_t                Base_;      // 元のストリーム上の先頭位置
+    std::size_t                BlockSize_;
+    std::size_t                RawSize_;
+    std::size_t                Position_;
+    std::vector<Block>         Index_;
+    std::vector<std::byte>     Buffer_;    // 展開済みまたは圧縮前のブロック
+    std::vector<std::byte>     Packed_;    // 圧縮済みのブロック
+    std::size_t                Cached_;    // Buffer_に展開済みのブロック番号
+    std::size_t                Written_;   // 書き込み済みの圧縮データのサイズ
+    bool                       Writable_;
+    bool                       Open_;
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_COMPRESS_HPP
@@ -0,0 +1,58 @@
+/** @file
+ * @brief ストリームコピー
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_COPY_HPP
+#define GRAPHENE_STREAM_COPY_HPP
+
+#include <cstddef>
+#include <limits>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief コピー方法
+ */
+enum CopyMethod {
+    CopyMethodBuffer,    ///< バッファを経由してRead,Writeでコピー
+    CopyMethodMapping,   ///< マップされた内容を直接Writeでコピー
+    CopyMethodKernel     ///< カーネル内でコピー(copy_file_range,sendfile)
+};
+
+/**
+ * @brief コピー結果構造体
+ */
+struct CopyResult {
+    std::size_t Size;       ///< コピーしたサイズ(bytes)
+    double      Seconds;    ///< コピーに掛かった時間(秒)
+    double      Throughput; ///< スループット(bytes/秒)
+    CopyMethod  Method;     ///< 使用したコピー方法
+};
+
+/**
+ * @brief ストリームのコピー
+ *
+ * 入力ストリームのストリームポインタの位置から、出力ストリームのストリームポインタの位置へ
+ * 最大size分のデータをコピーし、両方のストリームポインタをコピーした分だけ進めます。 @n
+ * 両方がDescriptorStreamを実装している場合は、copy_file_rangeまたはsendfileで
+ * ユーザー空間のバッファを経由せずにカーネル内でコピーします。 @n
+ * 入力がMappedStreamを実装している場合はマップされた内容を直接書き込みます。 @n
+ * それ以外の場合は大きなバッファを経由してコピーします。 @n
+ * 入力ストリームの終端に達した場合はそこで終了します。
+ *
+ * @param [out] output 出力ストリーム
+ * @param [in]  input  入力ストリーム
+ * @param [in]  size   コピーする最大サイズ(bytes)
+ * @return コピー結果
+ * @throw std::runtime_error 書き込み失敗
+ * @throw std::system_error  カーネル内でのコピーの失敗
+ */
+CopyResult CopyStream(SharedStream output, SharedStream input, std::size_t size = std::numeric_limits<std::size_t>::max());
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_COPY_HPP
@@ -48,14 +48,62 @@ public:
      *    ファイルが存在する場合は追記されます。
      *
      * fopenの形式に合わせていますが、[テキスト|バイナリ]の区別はされません。 @n
-     * バイナリモードのみをサポートし、"b"オプションは記述不要です。
+     * バイナリモードのみをサポートし、"b"オプションは記述不要です。 @n
+     * 読み込みモードに"d"オプションを付けた場合("rd","rbd")は、ページキャッシュを経由しない
+     * ダイレクトI/O(O_DIRECT)で開きます。 @n
+     * 大きなアセットを一度だけ読み込む場合に、他のファイルのページキャッシュを追い出さずに済みます。 @n
+     * 境界に揃っていない位置やサイズの読み込みは、内部の境界に揃えたバッファを経由して透過的に処理します。 @n
+     * O_DIRECTに未対応のファイルシステムでは、通常の読み込みの後にページキャッシュを解放します。 @n
+     * Windowsでは"d"オプションは無視されます。
      *
      * @param [in] path ファイルパス
      * @param [in] mode オープンモード
      * @return Streamの共有ポインタ
+     * @throw std::system_error     ファイルオープン失敗
+     * @throw std::invalid_argument 読み込みモード以外に"d"オプションを指定
+     */
+    virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+};
+
+/**
+ * @brief ディレクトリファクトリクラス
+ *
+ * ルートディレクトリからの相対パスでファイルを読み書きするためのファクトリクラスです。 @n
+ * ディレクトリ内のファイルを列挙できるため、VirtualFileSystemにマウントできます。
+ */
+class DirectoryFactory final : public StreamFactory, public EnumerableFactory {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] root ルートディレクトリのパス
+     */
+    explicit DirectoryFactory(const std::string& root);
+
+    /**
+     * @brief ファイルを開く
+     *
+     * ルートディレクトリからの相対パスで指定したファイルを開きます。 @n
+     * オープンモードはFileFactoryと同じです。
+     *
+     * @param [in] path ルートディレクトリからの相対パス
+     * @param [in] mode オープンモード
+     * @return Streamの共有ポインタ
      * @throw std::system_error ファイルオープン失敗
      */
     virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+
+    /**
+     * @brief ファイル名の取得
+     *
+     * ルートディレクトリ以下の全ての通常ファイルを再帰的に列挙します。
+     *
+     * @return 名前順に整列されたルートディレクトリからの相対パスの一覧
+     */
+    virtual std::vector<std::string> Names(void) const override;
+
+private:
+    std::string Root_;
 };
 
 } // namespace Graphene::Stream
@@ -0,0 +1,70 @@
+/** @file
+ * @brief メモリマップファイル入力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_MAPPED_HPP
+#define GRAPHENE_STREAM_MAPPED_HPP
+
+#include <cstddef>
+#include <span>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief マップ済みストリームインタフェース
+ *
+ * ストリームの内容全体がメモリ上に存在する場合に実装する追加のインタフェースです。 @n
+ * 対応しているかはdynamic_castで確認し、対応していれば
+ * Readによるコピーを行わずに内容を直接参照できます。
+ */
+class MappedStream {
+public:
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~MappedStream() {}
+
+    /**
+     * @brief 内容の取得
+     *
+     * ストリームの先頭から末尾までの内容を取得します。 @n
+     * 内容はストリームオブジェクトが削除されるまで有効です。 @n
+     * ストリームポインタの位置には影響しません。
+     *
+     * @return ストリームの内容
+     */
+    virtual std::span<const std::byte> Mapping(void) const = 0;
+};
+
+/**
+ * @brief メモリマップファイルファクトリクラス
+ *
+ * ファイルをメモリにマップして読み込むためのファクトリクラスです。 @n
+ * 生成されるストリームはMappedStreamを実装しています。
+ */
+class MappedFileFactory final : public StreamFactory {
+public:
+    /**
+     * @brief ファイルを開く
+     *
+     * パスで指定したファイルを読み込み専用でマップします。 @n
+     * オープンモードは"r"のみをサポートしています。 @n
+     * "d"オプションを付けた場合("rd","rbd")は無視して"r"と同じく開きます。 @n
+     * マップはCloseではなくストリームオブジェクトの削除と同時に解放されます。
+     *
+     * @param [in] path ファイルパス
+     * @param [in] mode オープンモード
+     * @return Streamの共有ポインタ
+     * @throw std::invalid_argument 未対応のオープンモード
+     * @throw std::system_error     ファイルマップ失敗
+     */
+    virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_MAPPED_HPP
@@ -0,0 +1,150 @@
+/** @file
+ * @brief メモリ入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_MEMORY_HPP
+#define GRAPHENE_STREAM_MEMORY_HPP
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <graphene/stream/mapped.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief メモリストリームクラス
+ *
+ * メモリ上のデータをストリームとして読み書きするクラスです。 @n
+ * 外部のデータを参照する読み込み専用モードと、
+ * 自身でデータを保持して書き込みに応じて拡張するモードがあります。
+ */
+class MemoryStream final : public Stream, public MappedStream {
+public:
+    /**
+     * @brief コンストラクタ(読み書き)
+     *
+     * データを所有する読み書き可能なストリームを生成します。 @n
+     * ストリームポインタは先頭に配置されます。
+     *
+     * @param [in] data 初期データ
+     */
+    explicit MemoryStream(std::vector<std::byte> data = {});
+
+    /**
+     * @brief コンストラクタ(読み込み専用)
+     *
+     * 外部のデータを参照する読み込み専用のストリームを生成します。 @n
+     * データはコピーされないため、ストリームより長く有効である必要があります。
+     *
+     * @param [in] data 参照するデータ
+     */
+    explicit MemoryStream(std::span<const std::byte> data);
+
+    MemoryStream(const MemoryStream&) = delete;
+    MemoryStream& operator=(const MemoryStream&) = delete;
+
+    virtual void Close(void) override;
+
+    virtual bool Flush(void) override;
+
+    virtual std::size_t Read(void* data, std::size_t size) override;
+
+    virtual std::span<const std::byte> Peek(std::size_t size) override;
+
+    using Stream::Peek;
+
+    virtual std::size_t Consume(std::size_t size) override;
+
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override;
+
+    virtual std::size_t Write(const void* data, std::size_t size) override;
+
+    virtual bool Seek(std::size_t offset) override;
+
+    virtual std::size_t Tell(void) const override;
+
+    virtual std::size_t Size(void) const override;
+
+    /**
+     * @brief 内容の取得
+     *
+     * 読み書き可能なストリームの場合、内容は次の書き込みまで有効です。
+     *
+     * @return ストリームの内容
+     */
+    virtual std::span<const std::byte> Mapping(void) const override;
+
+private:
+    std::vector<std::byte>     Buffer_;
+    std::span<const std::byte> View_;
+    std::size_t                Position_;
+    bool                       Writable_;
+    bool                       Open_;
+};
+
+/**
+ * @brief リソースファクトリクラス
+ *
+ * 登録したメモリ上のデータを名前で開くためのファクトリクラスです。 @n
+ * 実行ファイルに埋め込んだリソースをファイル入出力やコピーなしで読み込むために使用します。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class ResourceFactory final : public StreamFactory, public EnumerableFactory {
+public:
+    /**
+     * @brief リソースの登録
+     *
+     * 同じ名前のリソースが登録済みの場合は置き換えます。 @n
+     * データはコピーされないため、ファクトリとストリームより長く有効である必要があります。
+     *
+     * @param [in] name リソース名
+     * @param [in] data リソースデータ
+     * @return なし
+     */
+    void Register(const std::string& name, std::span<const std::byte> data);
+
+    /**
+     * @brief リソースを開く
+     *
+     * 名前で指定したリソースを読み込み専用のMemoryStreamとして開きます。 @n
+     * オープンモードは"r"のみをサポートしています。 @n
+     * リソースはメモリ上にあるため、"d"オプションを付けた場合("rd","rbd")は無視して"r"と同じく開きます。
+     *
+     * @param [in] path リソース名
+     * @param [in] mode オープンモード
+     * @return Streamの共有ポインタ
+     * @throw std::invalid_argument 未対応のオープンモード
+     * @throw std::system_error     リソースが存在しない
+     */
+    virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+
+    /**
+     * @brief リソース名の取得
+     *
+     * @return 名前順に整列されたリソース名の一覧
+     */
+    virtual std::vector<std::string> Names(void) const override;
+
+private:
+    mutable std::mutex                                Mutex_;
+    std::map<std::string, std::span<const std::byte>> Resources_;
+};
+
+/**
+ * @brief 組み込みリソースの取得
+ *
+ * 実行ファイルに埋め込んだリソースを全て登録したResourceFactoryを返します。 @n
+ * リソース名はsrcディレクトリからの相対パス(例: "graphics/shader/hlsl/test.vsh")です。 @n
+ * 全ての呼び出しで同じファクトリを返します。
+ *
+ * @return ResourceFactoryの共有ポインタ
+ */
+std::shared_ptr<ResourceFactory> GetBuiltinResources(void);
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_MEMORY_HPP
@@ -0,0 +1,173 @@
+/** @file
+ * @brief 入出力統計
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_STATS_HPP
+#define GRAPHENE_STREAM_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+namespace Detail {
+struct StreamCounters;
+} // namespace Detail
+
+/**
+ * @brief レイテンシのヒストグラム
+ *
+ * i番目の要素は[2^i, 2^(i+1))ナノ秒の範囲に入った回数です。
+ */
+using LatencyHistogram = std::array<std::uint64_t, 32>;
+
+/**
+ * @brief 入出力統計構造体
+ */
+struct StreamStatistics {
+    std::uint64_t    Opens;        ///< 開いた回数
+    std::uint64_t    OpenFailures; ///< 開くのに失敗した回数
+    std::uint64_t    Reads;        ///< 読み込み回数
+    std::uint64_t    Writes;       ///< 書き込み回数
+    std::uint64_t    BytesRead;    ///< 読み込んだサイズ(bytes)
+    std::uint64_t    BytesWritten; ///< 書き込んだサイズ(bytes)
+    std::uint64_t    OpenTime;     ///< 開くのに掛かった合計時間(ns)
+    std::uint64_t    ReadTime;     ///< 読み込みに掛かった合計時間(ns)
+    std::uint64_t    WriteTime;    ///< 書き込みに掛かった合計時間(ns)
+    LatencyHistogram OpenLatency;  ///< 開くのに掛かった時間の分布
+    LatencyHistogram ReadLatency;  ///< 1回の読み込みに掛かった時間の分布
+    LatencyHistogram WriteLatency; ///< 1回の書き込みに掛かった時間の分布
+};
+
+/**
+ * @brief 統計付きファクトリクラス
+ *
+ * 任意のファクトリをラップし、開いたストリームの入出力を計測するファクトリクラスです。 @n
+ * 統計はパスの先頭のディレクトリ(プレフィックス)ごとに集計されます。 @n
+ * 計測はロックのないアトミックなカウンタで行うため、製品版でも有効にしておけます。 @n
+ * 生成されるストリームは、元のストリームがMappedStreamまたはDescriptorStreamを実装していれば同じインタフェースを実装します
+ * (両方を実装している場合はMappedStreamのみ)。 @n
+ * MappingやDescriptorを経由した読み込み(CopyStreamのカーネル内コピーやAsyncReaderのio_uringなど)は
+ * ストリームの関数を呼び出さないため、統計に含まれません。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class InstrumentedFactory final : public StreamFactory {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * depthが0の場合は全てのパスを1つに集計します。
+     *
+     * @param [in] factory 元のファクトリ
+     * @param [in] depth   プレフィックスとして使用するディレクトリの階層数
+     */
+    explicit InstrumentedFactory(SharedStreamFactory factory, std::size_t depth = 1);
+
+    /**
+     * @brief デストラクタ
+     *
+     * 定期出力を停止します。
+     */
+    virtual ~InstrumentedFactory() override;
+
+    InstrumentedFactory(const InstrumentedFactory&) = delete;
+    InstrumentedFactory& operator=(const InstrumentedFactory&) = delete;
+
+    /**
+     * @brief ストリームを開く
+     *
+     * 元のファクトリでストリームを開き、計測用のストリームでラップします。 @n
+     * 開くのに失敗した場合も統計に記録し、例外をそのまま送出します。
+     *
+     * @param [in] path ストリーム識別文字列
+     * @param [in] mode オープンモード
+     * @return Streamの共有ポインタ
+     */
+    virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+
+    /**
+     * @brief プレフィックスごとの統計の取得
+     *
+     * @return プレフィックス順に整列された統計
+     */
+    std::map<std::string, StreamStatistics> Statistics(void) const;
+
+    /**
+     * @brief 全体の統計の取得
+     *
+     * @return 全てのプレフィックスの合計
+     */
+    StreamStatistics Total(void) const;
+
+    /**
+     * @brief 統計の初期化
+     *
+     * 全てのカウンタを0に戻します。
+     *
+     * @return なし
+     */
+    void Reset(void);
+
+    /**
+     * @brief 統計の出力
+     *
+     * プレフィックスごとの統計を1行ずつテキストで出力します。 @n
+     * レイテンシはヒストグラムから求めた中央値と99パーセンタイルの上限です。
+     *
+     * @param [out] out 出力先
+     * @return なし
+     */
+    void Dump(std::ostream& out) const;
+
+    /**
+     * @brief 定期出力の開始
+     *
+     * バックグラウンドのスレッドから一定間隔でDumpを呼び出します。 @n
+     * 既に開始している場合は出力先と間隔を変更します。 @n
+     * 出力先はStopDumpまたはオブジェクトの削除まで有効である必要があります。
+     *
+     * @param [out] out      出力先
+     * @param [in]  interval 出力間隔
+     * @return なし
+     */
+    void StartDump(std::ostream& out, std::chrono::milliseconds interval);
+
+    /**
+     * @brief 定期出力の停止
+     *
+     * @return なし
+     */
+    void StopDump(void);
+
+private:
+    std::shared_ptr<Detail::StreamCounters> Find(const std::string& path);
+
+private:
+    SharedStreamFactory                                                      Factory_;
+    std::size_t                                                              Depth_;
+    mutable std::shared_mutex                                                Mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Detail::StreamCounters>> Counters_;
+    std::mutex                                                               DumpMutex_;
+    std::condition_variable                                                  DumpCondition_;
+    std::ostream*                                                            DumpStream_;
+    std::chrono::milliseconds                                                DumpInterval_;
+    bool                                                                     DumpStop_;
+    std::thread                                                              DumpThread_;
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_STATS_HPP
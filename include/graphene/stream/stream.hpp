@@ -8,11 +8,43 @@
 #ifndef GRAPHENE_STREAM_STREAM_HPP
 #define GRAPHENE_STREAM_STREAM_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace Graphene::Stream {
 
+/**
+ * @brief アクセスパターンのヒント
+ */
+enum AccessHint {
+    AccessHintNormal,     ///< 既定のアクセス
+    AccessHintSequential, ///< 先頭から順番にアクセスする(先読みを増やす)
+    AccessHintRandom,     ///< ランダムにアクセスする(先読みを抑える)
+    AccessHintWillNeed,   ///< 指定範囲をすぐにアクセスする(先に読み込む)
+    AccessHintDontNeed    ///< 指定範囲にしばらくアクセスしない(キャッシュを解放する)
+};
+
+/**
+ * @brief 読み込みバッファ構造体
+ */
+struct ReadBuffer {
+    void*       Data; ///< 読み込むデータを格納するポインタ
+    std::size_t Size; ///< 読み込むサイズ(byte)
+};
+
+/**
+ * @brief 書き込みバッファ構造体
+ */
+struct WriteBuffer {
+    const void* Data; ///< 書き込むデータが格納されたポインタ
+    std::size_t Size; ///< 書き込むサイズ(byte)
+};
+
 /**
  * @brief ストリームインタフェース
  *
@@ -62,6 +94,85 @@ public:
      */
     virtual std::size_t Read(void* data, std::size_t size) = 0;
 
+    /**
+     * @brief ストリームのデータを参照
+     *
+     * ストリームポインタの位置から最大size分のデータを、コピーせずに参照できる場合は参照します。 @n
+     * ストリームポインタの位置は変わらず、読み進めるにはConsumeを呼び出します。 @n
+     * 終端に達した場合やコピーせずに参照できない場合は、短いデータまたは空のデータを返します。
+     * 足りない分はReadで読み込むか、scratchを受け取るPeekを使用してください。 @n
+     * 返されたデータはこのストリームに対して次に他の関数(const関数を除く)を呼び出すまで有効です。 @n
+     * 既定の実装は常に空のデータを返します。
+     *
+     * @param [in] size 参照するサイズ(byte)
+     * @return 参照できたデータ
+     */
+    virtual std::span<const std::byte> Peek(std::size_t size) {
+        return {};
+    }
+
+    /**
+     * @brief ストリームのデータを参照(コピーによる代替付き)
+     *
+     * Peekでsize分を参照できない場合は、ReadAtでscratchへコピーしてその内容を返します。 @n
+     * どちらの場合もストリームポインタの位置は変わらず、読み進めるにはConsumeを呼び出します。 @n
+     * 終端に達した場合のみsizeより短いデータを返します。 @n
+     * 返されたデータはこのストリームに対して次に他の関数(const関数を除く)を呼び出すか、
+     * scratchを変更するまで有効です。
+     *
+     * @param [in]     size    参照するサイズ(byte)
+     * @param [in,out] scratch コピーに使用するバッファ(必要に応じて拡張します)
+     * @return 参照またはコピーしたデータ
+     */
+    std::span<const std::byte> Peek(std::size_t size, std::vector<std::byte>& scratch) {
+        auto view = Peek(size);
+        if (view.size() == size) return view;
+        if (scratch.size() < size) scratch.resize(size);
+        return {scratch.data(), ReadAt(Tell(), scratch.data(), size)};
+    }
+
+    /**
+     * @brief ストリームのデータを読み進める
+     *
+     * ストリームポインタをsize分進めます。終端を超えては進めません。 @n
+     * Peekで参照したデータを処理した後に呼び出します。
+     *
+     * @param [in] size 読み進めるサイズ(byte)
+     * @return 実際に読み進めたサイズ(byte)
+     */
+    virtual std::size_t Consume(std::size_t size) {
+        auto position = Tell();
+        auto n        = std::min(size, Size() - std::min(position, Size()));
+        return Seek(position + n) ? n : 0;
+    }
+
+    /**
+     * @brief ストリームの指定位置からデータを読み込む
+     *
+     * ストリームの先頭からoffsetの位置から指定したサイズ分データを読み込みます。 @n
+     * ストリームポインタの位置は変わりません。 @n
+     * ストリームが開かれていない場合は何もせずに0を返します。 @n
+     * dataがnullptrの場合は何もせずに0を返します。 @n
+     * 同じストリームに対して複数のスレッドから同時に呼び出すことができます。
+     * ただし、Read,Write,Seekなどの他の関数との同時呼び出しは安全ではありません。 @n
+     * 既定の実装はストリームポインタを移動して読み込んだ後に元の位置へ戻すため、
+     * ストリームごとのロックにより直列化されます。 @n
+     * 他のストリームを読み込むストリームは、ロックの入れ子を避けるために独自に実装してください。
+     *
+     * @param [in]  offset ストリームの先頭からの位置(byte)
+     * @param [out] data   読み込むデータを格納するポインタ
+     * @param [in]  size   読み込むサイズ(byte)
+     * @return 実際に読み込まれたサイズ(byte)
+     */
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) {
+        if (!data) return 0;
+        std::lock_guard<std::mutex> lock(PositionMutex_);
+        auto position = Tell();
+        auto result   = Seek(offset) ? Read(data, size) : 0;
+        Seek(position);
+        return result;
+    }
+
     /**
      * @brief ストリームにデータを書き込む
      *
@@ -75,6 +186,87 @@ public:
      */
     virtual std::size_t Write(const void* data, std::size_t size) = 0;
 
+    /**
+     * @brief ストリームから複数のバッファへデータを読み込む
+     *
+     * ストリームポインタの位置から連続するデータを各バッファへ順番に読み込みます。 @n
+     * 途中で読み込みサイズが足りなくなった場合はそこで終了します。 @n
+     * 既定の実装はバッファごとにReadを呼び出します。
+     *
+     * @param [in] buffers 読み込みバッファの配列
+     * @return 実際に読み込まれた合計サイズ(byte)
+     */
+    virtual std::size_t ReadV(std::span<const ReadBuffer> buffers) {
+        auto total = std::size_t(0);
+        for (auto& buffer : buffers) {
+            auto n = Read(buffer.Data, buffer.Size);
+            total += n;
+            if (n < buffer.Size) break;
+        }
+        return total;
+    }
+
+    /**
+     * @brief ストリームの指定位置から複数のバッファへデータを読み込む
+     *
+     * ストリームの先頭からoffsetの位置から連続するデータを各バッファへ順番に読み込みます。 @n
+     * ストリームポインタの位置は変わらず、ReadAtと同様に複数のスレッドから同時に呼び出すことができます。 @n
+     * 既定の実装はバッファごとにReadAtを呼び出します。
+     *
+     * @param [in] offset  ストリームの先頭からの位置(byte)
+     * @param [in] buffers 読み込みバッファの配列
+     * @return 実際に読み込まれた合計サイズ(byte)
+     */
+    virtual std::size_t ReadV(std::size_t offset, std::span<const ReadBuffer> buffers) {
+        auto total = std::size_t(0);
+        for (auto& buffer : buffers) {
+            auto n = ReadAt(offset + total, buffer.Data, buffer.Size);
+            total += n;
+            if (n < buffer.Size) break;
+        }
+        return total;
+    }
+
+    /**
+     * @brief 複数のバッファからストリームにデータを書き込む
+     *
+     * ストリームポインタの位置から各バッファのデータを順番に連続して書き込みます。 @n
+     * 途中で書き込みサイズが足りなくなった場合はそこで終了します。 @n
+     * 既定の実装はバッファごとにWriteを呼び出します。
+     *
+     * @param [in] buffers 書き込みバッファの配列
+     * @return 実際に書き込まれた合計サイズ(byte)
+     */
+    virtual std::size_t WriteV(std::span<const WriteBuffer> buffers) {
+        auto total = std::size_t(0);
+        for (auto& buffer : buffers) {
+            auto n = Write(buffer.Data, buffer.Size);
+            total += n;
+            if (n < buffer.Size) break;
+        }
+        return total;
+    }
+
+    /**
+     * @brief 複数のバッファからストリームの指定位置にデータを書き込む
+     *
+     * ストリームの先頭からoffsetの位置から各バッファのデータを順番に連続して書き込みます。 @n
+     * ストリームポインタの位置は変わりません。 @n
+     * 既定の実装はストリームポインタを移動して書き込んだ後に元の位置へ戻すため、
+     * ReadAtの既定の実装と同じストリームごとのロックにより直列化されます。
+     *
+     * @param [in] offset  ストリームの先頭からの位置(byte)
+     * @param [in] buffers 書き込みバッファの配列
+     * @return 実際に書き込まれた合計サイズ(byte)
+     */
+    virtual std::size_t WriteV(std::size_t offset, std::span<const WriteBuffer> buffers) {
+        std::lock_guard<std::mutex> lock(PositionMutex_);
+        auto position = Tell();
+        auto result   = Seek(offset) ? WriteV(buffers) : 0;
+        Seek(position);
+        return result;
+    }
+
     /**
      * @brief ストリームポインタの位置を移動
      *
@@ -106,6 +298,26 @@ public:
      * @return offset ストリームのサイズ(byte)
      */
     virtual std::size_t Size(void) const = 0;
+
+    /**
+     * @brief アクセスパターンのヒントを通知
+     *
+     * これからのアクセスパターンをOSに通知し、先読みやキャッシュの扱いを最適化します。 @n
+     * ヒントは動作に影響せず、対応していないストリームでは無視されます。 @n
+     * sizeが0の場合はoffsetからストリームの終端までを対象にします。
+     *
+     * @param [in] hint   アクセスパターンのヒント
+     * @param [in] offset 対象範囲のストリームの先頭からの位置(byte)
+     * @param [in] size   対象範囲のサイズ(byte)
+     * @retval true  ヒントを通知した
+     * @retval false ヒントを無視した
+     */
+    virtual bool Advise(AccessHint hint, std::size_t offset = 0, std::size_t size = 0) {
+        return false;
+    }
+
+private:
+    std::mutex PositionMutex_; // 位置指定入出力の既定の実装で使用するロック
 };
 
 /**
@@ -168,6 +380,30 @@ public:
  */
 using SharedStreamFactory = std::shared_ptr<StreamFactory>;
 
+/**
+ * @brief 列挙可能ファクトリインタフェース
+ *
+ * 開くことができるストリームの一覧を取得できるファクトリが実装する追加のインタフェースです。 @n
+ * 対応しているかはdynamic_castで確認します。
+ */
+class EnumerableFactory {
+public:
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~EnumerableFactory() {}
+
+    /**
+     * @brief ストリーム識別文字列の取得
+     *
+     * 読み込みモードで開くことができるストリームの識別文字列の一覧を取得します。 @n
+     * ディレクトリの区切りには'/'を使用します。
+     *
+     * @return 名前順に整列された識別文字列の一覧
+     */
+    virtual std::vector<std::string> Names(void) const = 0;
+};
+
 } // namespace Graphene::Stream
 
 #endif // GRAPHENE_STREAM_STREAM_HPP
@@ -0,0 +1,101 @@
+/** @file
+ * @brief 仮想ファイルシステム
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_VFS_HPP
+#define GRAPHENE_STREAM_VFS_HPP
+
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief 仮想ファイルシステムクラス
+ *
+ * 複数のファクトリを優先度付きで重ねてマウントし、1つのファクトリとして扱うクラスです。 @n
+ * 同じパスが複数のファクトリに存在する場合は、優先度の高いファクトリのストリームを開きます。 @n
+ * 優先度が同じ場合は後からマウントしたファクトリが優先されます。 @n
+ * マウント時に全てのファクトリのパスを統合したハッシュテーブルを作成するため、
+ * 読み込み時のパスの解決は各ファクトリを順番に探索せずに定数時間で行います。 @n
+ * マウントするファクトリはEnumerableFactoryを実装している必要があります。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class VirtualFileSystem final : public StreamFactory, public EnumerableFactory {
+public:
+    /**
+     * @brief ファクトリのマウント
+     *
+     * ファクトリをマウントしてパスの索引を更新します。
+     *
+     * @param [in] factory  マウントするファクトリ
+     * @param [in] priority 優先度(大きいほど優先)
+     * @return なし
+     * @throw std::invalid_argument ファクトリがEnumerableFactoryを実装していない
+     */
+    void Mount(SharedStreamFactory factory, int priority = 0);
+
+    /**
+     * @brief ファクトリのアンマウント
+     *
+     * ファクトリをアンマウントしてパスの索引を更新します。 @n
+     * マウントされていない場合は何もしません。
+     *
+     * @param [in] factory アンマウントするファクトリ
+     * @return なし
+     */
+    void Unmount(SharedStreamFactory factory);
+
+    /**
+     * @brief 索引の更新
+     *
+     * マウント済みのファクトリのパスを再度列挙して索引を作り直します。 @n
+     * マウント後にディレクトリのファイルが追加または削除された場合に呼び出します。
+     *
+     * @return なし
+     */
+    void Refresh(void);
+
+    /**
+     * @brief ストリームを開く
+     *
+     * 読み込みモード("r","rb"またはそれらに"d"オプションを付けたもの)の場合は索引で解決したファクトリでストリームを開きます。 @n
+     * それ以外のモードの場合は最も優先度の高いファクトリでストリームを開き、
+     * 成功した場合はそのパスを索引に追加します。
+     *
+     * @param [in] path ストリーム識別文字列
+     * @param [in] mode オープンモード
+     * @return Streamの共有ポインタ
+     * @throw std::system_error 読み込みモードでパスが存在しない、またはマウントされていない
+     */
+    virtual SharedStream Open(const std::string& path, const std::string& mode) override;
+
+    /**
+     * @brief パスの取得
+     *
+     * @return 名前順に整列された全てのファクトリのパスの一覧
+     */
+    virtual std::vector<std::string> Names(void) const override;
+
+private:
+    struct Mounted {
+        SharedStreamFactory Factory;
+        int                 Priority;
+    };
+
+    void Rebuild(void);
+
+private:
+    mutable std::shared_mutex                            Mutex_;
+    std::vector<Mounted>                                 Mounts_; // 優先度の低い順
+    std::unordered_map<std::string, SharedStreamFactory> Index_;
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_VFS_HPP
@@ -0,0 +1,109 @@
+/** @file
+ * @brief 非同期書き込み
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_WRITEBEHIND_HPP
+#define GRAPHENE_STREAM_WRITEBEHIND_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <graphene/stream/stream.hpp>
+
+namespace Graphene::Stream {
+
+/**
+ * @brief 非同期書き込みストリームクラス
+ *
+ * 任意のストリームをラップし、書き込みをバックグラウンドのスレッドで行うクラスです。 @n
+ * Writeはデータをバッファにコピーするだけで戻り、バッファが一杯になると書き込みキューに渡します。 @n
+ * キューが一杯の場合のみ、空きができるまで待機します。 @n
+ * Flushは書き込み待ちのデータを全て書き出してから元のストリームをFlushする同期点です。 @n
+ * 元のストリームがDescriptorStreamを実装している場合は、ストレージへの書き込みの完了まで待機します。 @n
+ * Read,Seek,Sizeなどの書き込み以外の操作は、書き込み待ちのデータを書き出してから行います。 @n
+ * 元のストリームへの書き込みの失敗は、次のFlushの戻り値で通知されます。
+ */
+class WriteBehindStream final : public Stream {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] stream 元のストリーム
+     * @param [in] size   バッファサイズ(bytes)
+     * @param [in] count  書き込みキューに保持できるバッファ数
+     * @throw std::invalid_argument バッファサイズまたはバッファ数が0
+     */
+    explicit WriteBehindStream(SharedStream stream, std::size_t size = 256 * 1024, std::size_t count = 4);
+
+    /**
+     * @brief デストラクタ
+     *
+     * 書き込み待ちのデータを元のストリームへ書き出します。 @n
+     * 元のストリームは閉じません。
+     */
+    virtual ~WriteBehindStream() override;
+
+    WriteBehindStream(const WriteBehindStream&) = delete;
+    WriteBehindStream& operator=(const WriteBehindStream&) = delete;
+
+    virtual void Close(void) override;
+
+    virtual bool Flush(void) override;
+
+    virtual std::size_t Read(void* data, std::size_t size) override;
+
+    /**
+     * @brief ストリームの指定位置からデータを読み込む
+     *
+     * 書き込みキューが空になるまで待機し、元のストリームをFlushしてからReadAtで読み込みます。 @n
+     * まだキューに渡していないデータと重なる範囲はその内容で置き換えます。 @n
+     * 複数のスレッドから同時に呼び出すことができます。
+     *
+     * @param [in]  offset ストリームの先頭からの位置(byte)
+     * @param [out] data   読み込むデータを格納するポインタ
+     * @param [in]  size   読み込むサイズ(byte)
+     * @return 実際に読み込まれたサイズ(byte)
+     */
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override;
+
+    virtual std::size_t Write(const void* data, std::size_t size) override;
+
+    virtual bool Seek(std::size_t offset) override;
+
+    virtual std::size_t Tell(void) const override;
+
+    virtual std::size_t Size(void) const override;
+
+private:
+    void Submit(void);
+
+    void Wait(void) const;
+
+    void Run(void);
+
+private:
+    SharedStream                        Stream_;
+    std::size_t                         BufferSize_;
+    std::size_t                         BufferCount_;
+    std::vector<std::byte>              Current_;  // 書き込み中のバッファ
+    std::deque<std::vector<std::byte>>  Queue_;    // 書き込み待ちのバッファ
+    std::vector<std::vector<std::byte>> Free_;     // 再利用するバッファ
+    std::size_t                         Position_; // 論理的なストリームポインタの位置
+    mutable std::mutex                  Mutex_;
+    mutable std::condition_variable     Condition_;
+    bool                                Busy_;     // スレッドが書き込み中
+    bool                                Failed_;   // 書き込みに失敗した
+    bool                                Written_;  // Flush後に元のストリームへ書き込んだ
+    bool                                Stop_;
+    std::thread                         Thread_;
+};
+
+} // namespace Graphene::Stream
+
+#endif // GRAPHENE_STREAM_WRITEBEHIND_HPP
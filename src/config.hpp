@@ -0,0 +1,37 @@
+/** @file
+ * @brief ビルドコンフィグ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_CONFIG_HPP
+#define GRAPHENE_CONFIG_HPP
+
+// PNG画像の読み込みにlibpngを使用
+#define USE_LIBPNG 1
+
+// 非同期読み込みにio_uringを使用
+#define USE_IO_URING 1
+
+// コンポーネントとしてGLFWを使用
+#define USE_GLFW 0
+
+// コンポーネントとしてDirectX11を使用
+#define USE_DX11 0
+
+// 使用可能なウィンドウシステムを定義
+#define WINDOW_SYSTEM_WIN32 0
+#define WINDOW_SYSTEM_X11 1
+
+// 環境に応じて必要なマクロを定義
+#if USE_GLFW
+#if WINDOW_SYSTEM_WIN32
+#define GLFW_EXPOSE_NATIVE_WIN32
+#endif
+#if WINDOW_SYSTEM_X11
+#define GLFW_EXPOSE_NATIVE_X11
+#endif
+#endif
+
+#endif // GRAPHENE_CONFIG_HPP
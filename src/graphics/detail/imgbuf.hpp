@@ -0,0 +1,87 @@
+/** @file
+ * @brief 画像バッファ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_DETAIL_IMGBUF_HPP
+#define GRAPHENE_GRAPHICS_DETAIL_IMGBUF_HPP
+
+#include <vector>
+#include <graphene/graphics/image.hpp>
+#include "pixconv.hpp"
+
+namespace Graphene::Graphics::Detail {
+
+/**
+ * @brief 画像バッファクラス
+ *
+ * メモリ上に確保した画像データを保持するクラスです。 @n
+ * ブロック圧縮形式の場合、行間隔は4x4ブロック1行分のバイト数を表します。
+ */
+class ImageBuffer final : public Image {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] format ピクセルフォーマット
+     * @param [in] rank   次元数
+     * @param [in] width  横幅
+     * @param [in] height 縦幅
+     * @param [in] stride 行間隔(bytes)
+     */
+    ImageBuffer(PixelFormat format, std::size_t rank, std::size_t width, std::size_t height, std::size_t stride) :
+    Image_ (stride * GetRowCount(format, height)),
+    Rank_  (rank),
+    Length_{width, height},
+    Stride_(stride),
+    Format_(format) {
+    }
+
+    virtual const void* Data(void) const override {
+        return Image_.data();
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Image_.size();
+    }
+
+    virtual std::size_t Rank(void) const override {
+        return Rank_;
+    }
+
+    virtual std::size_t Length(std::size_t axis) const override {
+        return Rank_ > axis ? Length_[axis] : 1;
+    }
+
+    virtual std::size_t Stride(void) const override {
+        return Stride_;
+    }
+
+    virtual PixelFormat Format(void) const override {
+        return Format_;
+    }
+
+    /**
+     * @brief 書き込み先の取得
+     *
+     * 画像データの書き込み先を取得します。
+     *
+     * @return 画像データの先頭アドレス
+     */
+    std::byte* Buffer(void) noexcept {
+        return Image_.data();
+    }
+
+private:
+    std::vector<std::byte> Image_;
+    std::size_t            Rank_;
+    std::size_t            Length_[2];
+    std::size_t            Stride_;
+    PixelFormat            Format_;
+};
+
+} // namespace Graphene::Graphics::Detail
+
+#endif // GRAPHENE_GRAPHICS_DETAIL_IMGBUF_HPP
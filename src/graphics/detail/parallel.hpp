@@ -0,0 +1,52 @@
+/** @file
+ * @brief 並列処理
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_GRAPHICS_DETAIL_PARALLEL_HPP
+#define GRAPHENE_GRAPHICS_DETAIL_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Graphene::Graphics::Detail {
+
+/**
+ * @brief 並列ループ
+ *
+ * [0,count)の各インデックスについて関数を並列に呼び出します。 @n
+ * スレッド数はハードウェアの同時実行数を上限とし、
+ * 呼び出し元のスレッドも処理に参加します。 @n
+ * 関数は例外を送出してはいけません。
+ *
+ * @param [in] count 繰り返し回数
+ * @param [in] func  インデックスを受け取る関数
+ * @return なし
+ */
+template<class F>
+void ParallelFor(std::size_t count, F&& func) {
+    auto concurrency = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    auto next        = std::atomic<std::size_t>(0);
+    auto worker      = [&] {
+        for (auto i = next++; i < count; i = next++) func(i);
+    };
+    std::vector<std::thread> threads;
+    try {
+        for (std::size_t i = 1, n = std::min(count, concurrency); i < n; ++i) {
+            threads.emplace_back(worker);
+        }
+    } catch (...) {
+        for (auto& thread : threads) thread.join();
+        throw;
+    }
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+} // namespace Graphene::Graphics::Detail
+
+#endif // GRAPHENE_GRAPHICS_DETAIL_PARALLEL_HPP
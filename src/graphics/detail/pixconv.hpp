@@ -8,8 +8,10 @@
 #ifndef GRAPHENE_GRAPHICS_DETAIL_PIXCONV_HPP
 #define GRAPHENE_GRAPHICS_DETAIL_PIXCONV_HPP
 
+#include <cstring>
 #include <limits>
 #include <half.hpp>
+#include <graphene/graphics/types.hpp>
 
 namespace Graphene::Graphics::Detail {
 
@@ -182,29 +184,29 @@ xxxx_fpxx<T, U>::operator bgra_fp32() const {
 template<class T, class U>
 xxxx_fpxx<T, U>::operator rgba_un16() const {
     return {
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->r, 0, 1) * std::numeric_limits<_un16>::max()),
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->g, 0, 1) * std::numeric_limits<_un16>::max()),
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->b, 0, 1) * std::numeric_limits<_un16>::max()),
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->a, 0, 1) * std::numeric_limits<_un16>::max())
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->r, U(0), U(1)) * std::numeric_limits<_un16>::max()),
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->g, U(0), U(1)) * std::numeric_limits<_un16>::max()),
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->b, U(0), U(1)) * std::numeric_limits<_un16>::max()),
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->a, U(0), U(1)) * std::numeric_limits<_un16>::max())
     };
 }
 template<class T, class U>
 xxxx_fpxx<T, U>::operator bgra_un16() const {
     return {
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->b, 0, 1) * std::numeric_limits<_un16>::max()),
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->g, 0, 1) * std::numeric_limits<_un16>::max()),
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->r, 0, 1) * std::numeric_limits<_un16>::max()),
-        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->a, 0, 1) * std::numeric_limits<_un16>::max())
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->b, U(0), U(1)) * std::numeric_limits<_un16>::max()),
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->g, U(0), U(1)) * std::numeric_limits<_un16>::max()),
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->r, U(0), U(1)) * std::numeric_limits<_un16>::max()),
+        static_cast<_un16>(std::clamp<U>(reinterpret_cast<const T*>(this)->a, U(0), U(1)) * std::numeric_limits<_un16>::max())
     };
 }
-rgba_fp16& rgba_fp16::operator=(const rgba_fp32& pixel) {
+inline rgba_fp16& rgba_fp16::operator=(const rgba_fp32& pixel) {
     r = pixel.r;
     g = pixel.g;
     b = pixel.b;
     a = pixel.a;
     return *this;
 }
-bgra_fp16& bgra_fp16::operator=(const bgra_fp32& pixel) {
+inline bgra_fp16& bgra_fp16::operator=(const bgra_fp32& pixel) {
     b = pixel.b;
     g = pixel.g;
     r = pixel.r;
@@ -285,14 +287,14 @@ xxxx_8888<T>::operator bgra_un16() const {
         static_cast<_un16>(reinterpret_cast<const T*>(this)->a * 0x101)
     };
 }
-rgba_8888& rgba_8888::operator=(const rgba_un16& pixel) {
+inline rgba_8888& rgba_8888::operator=(const rgba_un16& pixel) {
     r = pixel.r >> 8;
     g = pixel.g >> 8;
     b = pixel.b >> 8;
     a = pixel.a >> 8;
     return *this;
 }
-bgra_8888& bgra_8888::operator=(const bgra_un16& pixel) {
+inline bgra_8888& bgra_8888::operator=(const bgra_un16& pixel) {
     b = pixel.b >> 8;
     g = pixel.g >> 8;
     r = pixel.r >> 8;
@@ -336,14 +338,14 @@ xxxx_4444<T>::operator bgra_un16() const {
         static_cast<_un16>(reinterpret_cast<const T*>(this)->a * 0x1111)
     };
 }
-rgba_4444& rgba_4444::operator=(const rgba_un16& pixel) {
+inline rgba_4444& rgba_4444::operator=(const rgba_un16& pixel) {
     r = pixel.r >> 12;
     g = pixel.g >> 12;
     b = pixel.b >> 12;
     a = pixel.a >> 12;
     return *this;
 }
-bgra_4444& bgra_4444::operator=(const bgra_un16& pixel) {
+inline bgra_4444& bgra_4444::operator=(const bgra_un16& pixel) {
     b = pixel.b >> 12;
     g = pixel.g >> 12;
     r = pixel.r >> 12;
@@ -387,14 +389,14 @@ xxxx_5551<T>::operator bgra_un16() const {
         static_cast<_un16>(reinterpret_cast<const T*>(this)->a * 0xffff)
     };
 }
-rgba_5551& rgba_5551::operator=(const rgba_un16& pixel) {
+inline rgba_5551& rgba_5551::operator=(const rgba_un16& pixel) {
     r = pixel.r >> 11;
     g = pixel.g >> 11;
     b = pixel.b >> 11;
     a = pixel.a >> 15;
     return *this;
 }
-bgra_5551& bgra_5551::operator=(const bgra_un16& pixel) {
+inline bgra_5551& bgra_5551::operator=(const bgra_un16& pixel) {
     b = pixel.b >> 11;
     g = pixel.g >> 11;
     r = pixel.r >> 11;
@@ -438,20 +440,20 @@ xxxx_5650<T>::operator bgra_un16() const {
         std::numeric_limits<_un16>::max()
     };
 }
-rgba_5650& rgba_5650::operator=(const rgba_un16& pixel) {
+inline rgba_5650& rgba_5650::operator=(const rgba_un16& pixel) {
     r = pixel.r >> 11;
     g = pixel.g >> 10;
     b = pixel.b >> 11;
     return *this;
 }
-bgra_5650& bgra_5650::operator=(const bgra_un16& pixel) {
+inline bgra_5650& bgra_5650::operator=(const bgra_un16& pixel) {
     b = pixel.b >> 11;
     g = pixel.g >> 10;
     r = pixel.r >> 11;
     return *this;
 }
 
-rgba_fp32 BurnAlpha(const rgba_fp32& pixel) {
+inline rgba_fp32 BurnAlpha(const rgba_fp32& pixel) {
     return {
         pixel.a * pixel.r,
         pixel.a * pixel.g,
@@ -459,7 +461,7 @@ rgba_fp32 BurnAlpha(const rgba_fp32& pixel) {
         pixel.a
     };
 }
-bgra_fp32 BurnAlpha(const bgra_fp32& pixel) {
+inline bgra_fp32 BurnAlpha(const bgra_fp32& pixel) {
     return {
         pixel.a * pixel.b,
         pixel.a * pixel.g,
@@ -467,19 +469,19 @@ bgra_fp32 BurnAlpha(const bgra_fp32& pixel) {
         pixel.a
     };
 }
-rgba_un16 BurnAlpha(const rgba_un16& pixel) {
+inline rgba_un16 BurnAlpha(const rgba_un16& pixel) {
     return {
-        static_cast<_un16>(pixel.a * pixel.r / 0xffff),
-        static_cast<_un16>(pixel.a * pixel.g / 0xffff),
-        static_cast<_un16>(pixel.a * pixel.b / 0xffff),
+        static_cast<_un16>(static_cast<std::uint32_t>(pixel.a) * pixel.r / 0xffff),
+        static_cast<_un16>(static_cast<std::uint32_t>(pixel.a) * pixel.g / 0xffff),
+        static_cast<_un16>(static_cast<std::uint32_t>(pixel.a) * pixel.b / 0xffff),
         static_cast<_un16>(pixel.a)
     };
 }
-bgra_un16 BurnAlpha(const bgra_un16& pixel) {
+inline bgra_un16 BurnAlpha(const bgra_un16& pixel) {
     return {
-        static_cast<_un16>(pixel.a * pixel.b / 0xffff),
-        static_cast<_un16>(pixel.a * pixel.g / 0xffff),
-        static_cast<_un16>(pixel.a * pixel.r / 0xffff),
+        static_cast<_un16>(static_cast<std::uint32_t>(pixel.a) * pixel.b / 0xffff),
+        static_cast<_un16>(static_cast<std::uint32_t>(pixel.a) * pixel.g / 0xffff),
+        static_cast<_un16>(static_cast<std::uint32_t>(pixel.a) * pixel.r / 0xffff),
         static_cast<_un16>(pixel.a)
     };
 }
@@ -515,7 +517,7 @@ void ConvertPixelFormat(T* dst, const U* src, std::size_t n) {
  * @param [in] source 変換元形式
  * @return 変換可能形式
  */
-PixelFormat GetConvertibleFormat(PixelFormat target, PixelFormat source) {
+inline PixelFormat GetConvertibleFormat(PixelFormat target, PixelFormat source) {
     switch (target) {
     case XXXX0000:
         return source;
@@ -585,7 +587,7 @@ PixelFormat GetConvertibleFormat(PixelFormat target, PixelFormat source) {
  * @param [in] format ピクセルフォーマット
  * @return 1ピクセルあたりのバイト数
  */
-std::size_t GetBytesPerPixel(PixelFormat format) {
+inline std::size_t GetBytesPerPixel(PixelFormat format) {
     switch (format) {
     case RGBAFP32:
     case BGRAFP32:
@@ -610,6 +612,131 @@ std::size_t GetBytesPerPixel(PixelFormat format) {
     }
 }
 
+/**
+ * @brief ピクセルフォーマットの変換
+ *
+ * 入力形式を実行時に指定してピクセルフォーマットを変換します。
+ *
+ * @param [out] dst    出力配列
+ * @param [in]  src    入力配列
+ * @param [in]  source 入力形式
+ * @param [in]  n      配列の長さ
+ * @retval true  成功
+ * @retval false 未対応の入力形式
+ */
+template<bool PMA, class T>
+bool ConvertPixelFormat(T* dst, const void* src, PixelFormat source, std::size_t n) {
+    switch (source) {
+    case RGBAFP32: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_fp32*>(src), n); return true;
+    case BGRAFP32: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_fp32*>(src), n); return true;
+    case RGBAFP16: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_fp16*>(src), n); return true;
+    case BGRAFP16: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_fp16*>(src), n); return true;
+    case RGBAUN16: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_un16*>(src), n); return true;
+    case BGRAUN16: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_un16*>(src), n); return true;
+    case RGBA8888: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_8888*>(src), n); return true;
+    case BGRA8888: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_8888*>(src), n); return true;
+    case RGBA4444: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_4444*>(src), n); return true;
+    case BGRA4444: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_4444*>(src), n); return true;
+    case RGBA5551: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_5551*>(src), n); return true;
+    case BGRA5551: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_5551*>(src), n); return true;
+    case RGBA5650: ConvertPixelFormat<PMA>(dst, static_cast<const rgba_5650*>(src), n); return true;
+    case BGRA5650: ConvertPixelFormat<PMA>(dst, static_cast<const bgra_5650*>(src), n); return true;
+    default:       return false;
+    }
+}
+
+/**
+ * @brief ピクセルフォーマットの変換
+ *
+ * 入出力形式を実行時に指定してピクセルフォーマットを変換します。 @n
+ * 入出力形式が等しくアルファを焼き込まない場合は単純にコピーします。
+ *
+ * @param [out] dst    出力配列
+ * @param [in]  target 出力形式
+ * @param [in]  src    入力配列
+ * @param [in]  source 入力形式
+ * @param [in]  n      配列の長さ
+ * @retval true  成功
+ * @retval false 未対応の変換パターン
+ */
+template<bool PMA>
+bool ConvertPixelFormat(void* dst, PixelFormat target, const void* src, PixelFormat source, std::size_t n) {
+    if (!PMA && target == source && GetBytesPerPixel(source)) {
+        std::memcpy(dst, src, GetBytesPerPixel(source) * n);
+        return true;
+    }
+    switch (target) {
+    case RGBAFP32: return ConvertPixelFormat<PMA>(static_cast<rgba_fp32*>(dst), src, source, n);
+    case BGRAFP32: return ConvertPixelFormat<PMA>(static_cast<bgra_fp32*>(dst), src, source, n);
+    case RGBAFP16: return ConvertPixelFormat<PMA>(static_cast<rgba_fp16*>(dst), src, source, n);
+    case BGRAFP16: return ConvertPixelFormat<PMA>(static_cast<bgra_fp16*>(dst), src, source, n);
+    case RGBAUN16: return ConvertPixelFormat<PMA>(static_cast<rgba_un16*>(dst), src, source, n);
+    case BGRAUN16: return ConvertPixelFormat<PMA>(static_cast<bgra_un16*>(dst), src, source, n);
+    case RGBA8888: return ConvertPixelFormat<PMA>(static_cast<rgba_8888*>(dst), src, source, n);
+    case BGRA8888: return ConvertPixelFormat<PMA>(static_cast<bgra_8888*>(dst), src, source, n);
+    case RGBA4444: return ConvertPixelFormat<PMA>(static_cast<rgba_4444*>(dst), src, source, n);
+    case BGRA4444: return ConvertPixelFormat<PMA>(static_cast<bgra_4444*>(dst), src, source, n);
+    case RGBA5551: return ConvertPixelFormat<PMA>(static_cast<rgba_5551*>(dst), src, source, n);
+    case BGRA5551: return ConvertPixelFormat<PMA>(static_cast<bgra_5551*>(dst), src, source, n);
+    case RGBA5650: return ConvertPixelFormat<PMA>(static_cast<rgba_5650*>(dst), src, source, n);
+    case BGRA5650: return ConvertPixelFormat<PMA>(static_cast<bgra_5650*>(dst), src, source, n);
+    default:       return false;
+    }
+}
+
+/**
+ * @brief ブロックサイズの取得
+ *
+ * 指定したブロック圧縮形式の、
+ * 4x4ピクセルのブロックあたりのバイト数を取得します。 @n
+ * ブロック圧縮形式でない場合は0を返します。
+ *
+ * @param [in] format ピクセルフォーマット
+ * @return 1ブロックあたりのバイト数
+ */
+inline std::size_t GetBytesPerBlock(PixelFormat format) {
+    switch (format) {
+    case BC1UNORM:
+    case BC4UNORM:
+        return 8;
+    case BC3UNORM:
+    case BC5UNORM:
+    case BC7UNORM:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 行サイズの取得
+ *
+ * 指定した横幅の1行を格納するのに必要なバイト数を取得します。 @n
+ * ブロック圧縮形式の場合は4x4ブロック1行分のバイト数を返します。
+ *
+ * @param [in] format ピクセルフォーマット
+ * @param [in] width  横幅
+ * @return 1行あたりのバイト数
+ */
+inline std::size_t GetBytesPerRow(PixelFormat format, std::size_t width) {
+    if (auto bytes = GetBytesPerBlock(format)) return (width + 3) / 4 * bytes;
+    return GetBytesPerPixel(format) * width;
+}
+
+/**
+ * @brief 行数の取得
+ *
+ * 指定した縦幅の画像を格納するのに必要な行数を取得します。 @n
+ * ブロック圧縮形式の場合は4x4ブロックの行数を返します。
+ *
+ * @param [in] format ピクセルフォーマット
+ * @param [in] height 縦幅
+ * @return 行数
+ */
+inline std::size_t GetRowCount(PixelFormat format, std::size_t height) {
+    return GetBytesPerBlock(format) ? (height + 3) / 4 : height;
+}
+
 } // namespace Graphene::Graphics::Detail
 
 #endif // GRAPHENE_GRAPHICS_DETAIL_PIXCONV_HPP
@@ -0,0 +1,250 @@
+/** @file
+ * @brief アトラス画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/atlas.hpp>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include "../detail/pixconv.hpp"
+
+namespace Graphene::Graphics {
+
+namespace {
+
+struct Rect {
+    std::size_t X;
+    std::size_t Y;
+    std::size_t W;
+    std::size_t H;
+
+    bool Contains(const Rect& r) const {
+        return r.X >= X && r.Y >= Y && r.X + r.W <= X + W && r.Y + r.H <= Y + H;
+    }
+
+    bool Intersects(const Rect& r) const {
+        return r.X < X + W && X < r.X + r.W && r.Y < Y + H && Y < r.Y + r.H;
+    }
+};
+
+// MaxRects法(Best Short Side Fit)による矩形配置
+class Packer {
+public:
+    Packer(std::size_t width, std::size_t height) :
+    Free_{{0, 0, width, height}} {
+    }
+
+    bool Find(std::size_t w, std::size_t h, Rect& result) const {
+        auto best = std::make_tuple(~std::size_t(0), ~std::size_t(0));
+        for (auto& f : Free_) {
+            if (f.W < w || f.H < h) continue;
+            auto score = std::make_tuple(std::min(f.W - w, f.H - h), std::max(f.W - w, f.H - h));
+            if (score < best) {
+                best   = score;
+                result = {f.X, f.Y, w, h};
+            }
+        }
+        return std::get<0>(best) != ~std::size_t(0);
+    }
+
+    void Place(const Rect& used) {
+        std::vector<Rect> next;
+        next.reserve(Free_.size() + 4);
+        for (auto& f : Free_) {
+            if (!f.Intersects(used)) {
+                next.push_back(f);
+                continue;
+            }
+            if (used.X > f.X)                 next.push_back({f.X, f.Y, used.X - f.X, f.H});
+            if (used.X + used.W < f.X + f.W) next.push_back({used.X + used.W, f.Y, f.X + f.W - used.X - used.W, f.H});
+            if (used.Y > f.Y)                 next.push_back({f.X, f.Y, f.W, used.Y - f.Y});
+            if (used.Y + used.H < f.Y + f.H) next.push_back({f.X, used.Y + used.H, f.W, f.Y + f.H - used.Y - used.H});
+        }
+        // 他の空き領域に包含される空き領域を取り除く
+        Free_.clear();
+        for (std::size_t i = 0; i < next.size(); ++i) {
+            auto contained = false;
+            for (std::size_t j = 0; j < next.size() && !contained; ++j) {
+                if (i == j || !next[j].Contains(next[i])) continue;
+                contained = !next[i].Contains(next[j]) || j < i; // 同一の矩形は先頭のみ残す
+            }
+            if (!contained) Free_.push_back(next[i]);
+        }
+    }
+
+private:
+    std::vector<Rect> Free_;
+};
+
+class ImageAtlasBuffer final : public ImageAtlas {
+public:
+    ImageAtlasBuffer(PixelFormat format, std::size_t width, std::size_t height, std::size_t padding, std::size_t extrude, Packer packer) :
+    Packer_ (std::move(packer)),
+    Format_ (format),
+    Length_ {width, height},
+    Stride_ ((Detail::GetBytesPerPixel(format) * width + 3) & ~std::size_t(3)), // align to 4 bytes
+    Padding_(padding),
+    Extrude_(extrude),
+    Used_   (0) {
+        Image_.resize(Stride_ * height);
+    }
+
+    virtual const void* Data(void) const override {
+        return Image_.data();
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Image_.size();
+    }
+
+    virtual std::size_t Rank(void) const override {
+        return 2;
+    }
+
+    virtual std::size_t Length(std::size_t axis) const override {
+        return axis < 2 ? Length_[axis] : 1;
+    }
+
+    virtual std::size_t Stride(void) const override {
+        return Stride_;
+    }
+
+    virtual PixelFormat Format(void) const override {
+        return Format_;
+    }
+
+    virtual bool Insert(const SharedImage image) override {
+        Validate(image);
+        Rect rect;
+        if (!Packer_.Find(Outer(image->Length(0)), Outer(image->Length(1)), rect)) return false;
+        Packer_.Place(rect);
+        Draw(image, rect);
+        return true;
+    }
+
+    virtual std::size_t Count(void) const override {
+        return Regions_.size();
+    }
+
+    virtual const AtlasRegion& Region(std::size_t index) const override {
+        return Regions_.at(index);
+    }
+
+    virtual double Efficiency(void) const override {
+        return static_cast<double>(Used_) / (Length_[0] * Length_[1]);
+    }
+
+    std::size_t Outer(std::size_t length) const {
+        return length + Extrude_ * 2 + Padding_;
+    }
+
+    void Draw(const SharedImage image, const Rect& rect) {
+        auto bytes  = Detail::GetBytesPerPixel(Format_);
+        auto width  = image->Length(0);
+        auto height = image->Length(1);
+        auto x      = rect.X + Extrude_;
+        auto y      = rect.Y + Extrude_;
+        auto src    = static_cast<const std::byte*>(image->Data());
+        for (std::size_t i = 0; i < height; ++i) {
+            auto row = Image_.data() + (y + i) * Stride_;
+            Detail::ConvertPixelFormat<false>(row + x * bytes, Format_, src + i * image->Stride(), image->Format(), width);
+            for (std::size_t e = 1; e <= Extrude_; ++e) {
+                std::memcpy(row + (x - e) * bytes,             row + x * bytes,                   bytes);
+                std::memcpy(row + (x + width - 1 + e) * bytes, row + (x + width - 1) * bytes, bytes);
+            }
+        }
+        auto line = (width + Extrude_ * 2) * bytes;
+        for (std::size_t e = 1; e <= Extrude_; ++e) {
+            std::memcpy(Image_.data() + (y - e) * Stride_ + rect.X * bytes,              Image_.data() + y * Stride_ + rect.X * bytes,                line);
+            std::memcpy(Image_.data() + (y + height - 1 + e) * Stride_ + rect.X * bytes, Image_.data() + (y + height - 1) * Stride_ + rect.X * bytes, line);
+        }
+        Regions_.push_back({
+            x, y, width, height,
+            static_cast<float>(x)          / Length_[0],
+            static_cast<float>(y)          / Length_[1],
+            static_cast<float>(x + width)  / Length_[0],
+            static_cast<float>(y + height) / Length_[1]
+        });
+        Used_ += width * height;
+    }
+
+    static void Validate(const SharedImage image) {
+        if (image->Rank() > 2 || !image->Length(0) || !image->Length(1) || !Detail::GetBytesPerPixel(image->Format())) {
+            throw std::invalid_argument("ImageAtlas: Unsupported image.");
+        }
+    }
+
+private:
+    Packer                   Packer_;
+    std::vector<std::byte>   Image_;
+    PixelFormat              Format_;
+    std::size_t              Length_[2];
+    std::size_t              Stride_;
+    std::size_t              Padding_;
+    std::size_t              Extrude_;
+    std::size_t              Used_;
+    std::vector<AtlasRegion> Regions_;
+};
+
+// パディングは右端と下端に確保するため、アトラスの右端と下端ではみ出しを許容する
+Packer MakePacker(std::size_t width, std::size_t height, std::size_t padding) {
+    return Packer(width + padding, height + padding);
+}
+
+} // namespace
+
+SharedAtlas CreateImageAtlas(PixelFormat format, std::size_t width, std::size_t height, std::size_t padding, std::size_t extrude) {
+    if (!Detail::GetBytesPerPixel(format)) {
+        throw std::invalid_argument("CreateImageAtlas: Unsupported format.");
+    }
+    return std::make_shared<ImageAtlasBuffer>(format, width, height, padding, extrude, MakePacker(width, height, padding));
+}
+
+SharedAtlas BuildImageAtlas(const std::vector<SharedImage>& images, PixelFormat format, std::size_t maxSize, std::size_t padding, std::size_t extrude) {
+    if (!Detail::GetBytesPerPixel(format)) {
+        throw std::invalid_argument("BuildImageAtlas: Unsupported format.");
+    }
+    auto outer = [&](std::size_t length) { return length + extrude * 2 + padding; };
+    std::size_t area = 0;
+    for (auto& image : images) {
+        ImageAtlasBuffer::Validate(image);
+        area += outer(image->Length(0)) * outer(image->Length(1));
+    }
+    // 大きい画像から配置した方が隙間が少なくなる
+    std::vector<std::size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        auto& ia = images[a];
+        auto& ib = images[b];
+        return std::make_tuple(ia->Length(0) * ia->Length(1), std::max(ia->Length(0), ia->Length(1))) >
+               std::make_tuple(ib->Length(0) * ib->Length(1), std::max(ib->Length(0), ib->Length(1)));
+    });
+    // 1x1,2x1,2x2,4x2...の順に全ての画像が収まるサイズを探す
+    std::vector<Rect> rects(images.size());
+    for (std::size_t width = 1, height = 1; width <= maxSize; (width == height ? width : height) <<= 1) {
+        if ((width + padding) * (height + padding) < area) continue;
+        auto packer = MakePacker(width, height, padding);
+        auto fit    = true;
+        for (auto i : order) {
+            if (!packer.Find(outer(images[i]->Length(0)), outer(images[i]->Length(1)), rects[i])) {
+                fit = false;
+                break;
+            }
+            packer.Place(rects[i]);
+        }
+        if (!fit) continue;
+        auto atlas = std::make_shared<ImageAtlasBuffer>(format, width, height, padding, extrude, std::move(packer));
+        for (std::size_t i = 0; i < images.size(); ++i) {
+            atlas->Draw(images[i], rects[i]);
+        }
+        return atlas;
+    }
+    throw std::length_error("BuildImageAtlas: Images do not fit in max size.");
+}
+
+} // namespace Graphene::Graphics
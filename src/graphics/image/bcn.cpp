@@ -0,0 +1,446 @@
+/** @file
+ * @brief BCn圧縮画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/bcn.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "../detail/imgbuf.hpp"
+#include "../detail/parallel.hpp"
+#include "../detail/pixconv.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Graphene::Graphics {
+
+namespace {
+
+struct alignas(16) Block {
+    float r[16];
+    float g[16];
+    float b[16];
+    float a[16];
+};
+
+// BC7の4ビットインデックス補間係数
+constexpr int BC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// 重み付き平均と主成分軸を求める
+void ComputeAxis(const float* const* ch, std::size_t nc, const float* weight, float* mean, float* axis) {
+    float total = 0.0f;
+    for (std::size_t c = 0; c < nc; ++c) mean[c] = 0.0f;
+    for (std::size_t i = 0; i < 16; ++i) {
+        total += weight[i];
+        for (std::size_t c = 0; c < nc; ++c) mean[c] += weight[i] * ch[c][i];
+    }
+    for (std::size_t c = 0; c < nc; ++c) mean[c] /= total;
+    float cov[4][4] = {};
+    for (std::size_t i = 0; i < 16; ++i) {
+        float d[4];
+        for (std::size_t c = 0; c < nc; ++c) d[c] = ch[c][i] - mean[c];
+        for (std::size_t c = 0; c < nc; ++c) {
+            for (std::size_t k = c; k < nc; ++k) cov[c][k] += weight[i] * d[c] * d[k];
+        }
+    }
+    for (std::size_t c = 0; c < nc; ++c) {
+        for (std::size_t k = 0; k < c; ++k) cov[c][k] = cov[k][c];
+        axis[c] = 1.0f;
+    }
+    // べき乗法で最大固有ベクトルを近似
+    for (int n = 0; n < 8; ++n) {
+        float next[4] = {}, norm = 0.0f;
+        for (std::size_t c = 0; c < nc; ++c) {
+            for (std::size_t k = 0; k < nc; ++k) next[c] += cov[c][k] * axis[k];
+            norm = std::max(norm, std::abs(next[c]));
+        }
+        if (norm <= 0.0f) break;
+        for (std::size_t c = 0; c < nc; ++c) axis[c] = next[c] / norm;
+    }
+    float length = 0.0f;
+    for (std::size_t c = 0; c < nc; ++c) length += axis[c] * axis[c];
+    length = std::sqrt(length);
+    for (std::size_t c = 0; c < nc; ++c) axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+}
+
+// 主成分軸上の射影範囲を求める(重み0のピクセルは平均値として扱う)
+void ProjectRange(const float* const* ch, std::size_t nc, const float* weight, const float* mean, const float* axis, float& tmin, float& tmax) {
+#if defined(__SSE2__)
+    auto vmin = _mm_setzero_ps();
+    auto vmax = _mm_setzero_ps();
+    for (std::size_t i = 0; i < 16; i += 4) {
+        auto t = _mm_setzero_ps();
+        for (std::size_t c = 0; c < nc; ++c) {
+            auto d = _mm_sub_ps(_mm_load_ps(ch[c] + i), _mm_set1_ps(mean[c]));
+            t = _mm_add_ps(t, _mm_mul_ps(d, _mm_set1_ps(axis[c])));
+        }
+        t    = _mm_and_ps(t, _mm_cmpgt_ps(_mm_load_ps(weight + i), _mm_setzero_ps()));
+        vmin = _mm_min_ps(vmin, t);
+        vmax = _mm_max_ps(vmax, t);
+    }
+    alignas(16) float lo[4], hi[4];
+    _mm_store_ps(lo, vmin);
+    _mm_store_ps(hi, vmax);
+    tmin = std::min({lo[0], lo[1], lo[2], lo[3]});
+    tmax = std::max({hi[0], hi[1], hi[2], hi[3]});
+#else
+    tmin = tmax = 0.0f;
+    for (std::size_t i = 0; i < 16; ++i) {
+        if (weight[i] <= 0.0f) continue;
+        float t = 0.0f;
+        for (std::size_t c = 0; c < nc; ++c) t += (ch[c][i] - mean[c]) * axis[c];
+        tmin = std::min(tmin, t);
+        tmax = std::max(tmax, t);
+    }
+#endif
+}
+
+// 各ピクセルに最も近いパレットのインデックスを求め、重み付き二乗誤差を返す
+float FindIndices(const float* const* ch, std::size_t nc, const float* weight, const float (*palette)[4], std::size_t np, std::uint8_t* index) {
+    float error = 0.0f;
+#if defined(__SSE2__)
+    for (std::size_t i = 0; i < 16; i += 4) {
+        auto best  = _mm_set1_ps(std::numeric_limits<float>::max());
+        auto bestI = _mm_setzero_si128();
+        for (std::size_t p = 0; p < np; ++p) {
+            auto d = _mm_setzero_ps();
+            for (std::size_t c = 0; c < nc; ++c) {
+                auto e = _mm_sub_ps(_mm_load_ps(ch[c] + i), _mm_set1_ps(palette[p][c]));
+                d = _mm_add_ps(d, _mm_mul_ps(e, e));
+            }
+            auto mask = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            best  = _mm_min_ps(best, d);
+            bestI = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(p)), _mm_andnot_si128(mask, bestI));
+        }
+        alignas(16) float        e[4];
+        alignas(16) std::int32_t k[4];
+        _mm_store_ps(e, _mm_mul_ps(best, _mm_load_ps(weight + i)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(k), bestI);
+        for (std::size_t j = 0; j < 4; ++j) {
+            index[i + j] = static_cast<std::uint8_t>(k[j]);
+            error += e[j];
+        }
+    }
+#else
+    for (std::size_t i = 0; i < 16; ++i) {
+        float best = std::numeric_limits<float>::max();
+        for (std::size_t p = 0; p < np; ++p) {
+            float d = 0.0f;
+            for (std::size_t c = 0; c < nc; ++c) {
+                auto e = ch[c][i] - palette[p][c];
+                d += e * e;
+            }
+            if (d < best) {
+                best     = d;
+                index[i] = static_cast<std::uint8_t>(p);
+            }
+        }
+        error += best * weight[i];
+    }
+#endif
+    return error;
+}
+
+// インデックスに対応する補間係数から最小二乗法で端点を求める
+bool FitEndpoints(const float* const* ch, std::size_t nc, const float* weight, const float* alpha, const std::uint8_t* index, float* e0, float* e1) {
+    float a = 0.0f, b = 0.0f, c = 0.0f, x0[4] = {}, x1[4] = {};
+    for (std::size_t i = 0; i < 16; ++i) {
+        auto t = alpha[index[i]];
+        auto s = 1.0f - t;
+        a += weight[i] * s * s;
+        b += weight[i] * s * t;
+        c += weight[i] * t * t;
+        for (std::size_t k = 0; k < nc; ++k) {
+            x0[k] += weight[i] * s * ch[k][i];
+            x1[k] += weight[i] * t * ch[k][i];
+        }
+    }
+    auto det = a * c - b * b;
+    if (std::abs(det) < 1e-6f) return false;
+    for (std::size_t k = 0; k < nc; ++k) {
+        e0[k] = std::clamp((c * x0[k] - b * x1[k]) / det, 0.0f, 255.0f);
+        e1[k] = std::clamp((a * x1[k] - b * x0[k]) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+//==============================================================================
+// BC1(カラー)
+//==============================================================================
+std::uint16_t Pack565(const float* c) {
+    auto r = static_cast<std::uint16_t>(std::lround(std::clamp(c[0], 0.0f, 255.0f) * 31 / 255));
+    auto g = static_cast<std::uint16_t>(std::lround(std::clamp(c[1], 0.0f, 255.0f) * 63 / 255));
+    auto b = static_cast<std::uint16_t>(std::lround(std::clamp(c[2], 0.0f, 255.0f) * 31 / 255));
+    return r << 11 | g << 5 | b;
+}
+
+void Unpack565(std::uint16_t v, float* c) {
+    auto r = v >> 11 & 0x1f;
+    auto g = v >>  5 & 0x3f;
+    auto b = v       & 0x1f;
+    c[0] = static_cast<float>(r << 3 | r >> 2);
+    c[1] = static_cast<float>(g << 2 | g >> 4);
+    c[2] = static_cast<float>(b << 3 | b >> 2);
+    c[3] = 0.0f;
+}
+
+float FitColor(const float* const* ch, const float* weight, std::uint16_t c0, std::uint16_t c1, bool threeColor, std::uint8_t* index) {
+    float palette[4][4];
+    Unpack565(c0, palette[0]);
+    Unpack565(c1, palette[1]);
+    for (std::size_t c = 0; c < 3; ++c) {
+        if (threeColor) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+        } else {
+            palette[2][c] = (palette[0][c] * 2 + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + palette[1][c] * 2) / 3;
+        }
+    }
+    return FindIndices(ch, 3, weight, palette, threeColor ? 3 : 4, index);
+}
+
+void EncodeColor(const Block& block, std::uint8_t* out, bool punchThrough, CompressQuality quality) {
+    alignas(16) float weight[16];
+    bool transparent = false, opaque = false;
+    for (std::size_t i = 0; i < 16; ++i) {
+        weight[i]    = punchThrough && block.a[i] < 128.0f ? 0.0f : 1.0f;
+        transparent |= weight[i] == 0.0f;
+        opaque      |= weight[i] != 0.0f;
+    }
+    std::uint16_t c0 = 0, c1 = 0;
+    std::uint8_t  index[16] = {};
+    if (opaque) {
+        const float* ch[3] = {block.r, block.g, block.b};
+        float mean[4], axis[4], tmin, tmax, e0[4], e1[4];
+        ComputeAxis(ch, 3, weight, mean, axis);
+        ProjectRange(ch, 3, weight, mean, axis, tmin, tmax);
+        for (std::size_t c = 0; c < 3; ++c) {
+            e0[c] = mean[c] + axis[c] * tmax;
+            e1[c] = mean[c] + axis[c] * tmin;
+        }
+        c0 = Pack565(e0);
+        c1 = Pack565(e1);
+        auto error = FitColor(ch, weight, c0, c1, transparent, index);
+        if (quality == CompressQualityHigh) {
+            static constexpr float alpha3[3] = {0.0f, 1.0f, 1.0f / 2};
+            static constexpr float alpha4[4] = {0.0f, 1.0f, 1.0f / 3, 2.0f / 3};
+            for (int n = 0; n < 2 && error > 0.0f; ++n) {
+                if (!FitEndpoints(ch, 3, weight, transparent ? alpha3 : alpha4, index, e0, e1)) break;
+                std::uint8_t next[16];
+                auto n0 = Pack565(e0);
+                auto n1 = Pack565(e1);
+                auto e  = FitColor(ch, weight, n0, n1, transparent, next);
+                if (e >= error) break;
+                c0    = n0;
+                c1    = n1;
+                error = e;
+                std::copy(next, next + 16, index);
+            }
+        }
+    }
+    // 端点の大小関係でモードが決まるため並びを調整する
+    if (transparent) {
+        if (c0 > c1) {
+            std::swap(c0, c1);
+            for (auto& i : index) if (i < 2) i ^= 1;
+        }
+        for (std::size_t i = 0; i < 16; ++i) if (weight[i] == 0.0f) index[i] = 3;
+    } else if (c0 < c1) {
+        std::swap(c0, c1);
+        for (auto& i : index) i ^= 1;
+    } else if (c0 == c1) {
+        std::fill(index, index + 16, 0);
+    }
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < 16; ++i) bits |= static_cast<std::uint32_t>(index[i]) << (i * 2);
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for (std::size_t i = 0; i < 4; ++i) out[4 + i] = bits >> (i * 8) & 0xff;
+}
+
+//==============================================================================
+// BC4(単一チャンネル)
+//==============================================================================
+void EncodeSingle(const float* v, std::uint8_t* out) {
+    auto [lo, hi] = std::minmax_element(v, v + 16);
+    auto a0 = static_cast<int>(std::lround(*hi));
+    auto a1 = static_cast<int>(std::lround(*lo));
+    std::uint64_t bits = 0;
+    if (a0 > a1) {
+        for (std::size_t i = 0; i < 16; ++i) {
+            auto p = std::clamp<long>(std::lround((v[i] - a1) * 7 / (a0 - a1)), 0, 7);
+            auto k = p == 7 ? 0 : p == 0 ? 1 : 8 - p;
+            bits |= static_cast<std::uint64_t>(k) << (i * 3);
+        }
+    }
+    out[0] = static_cast<std::uint8_t>(a0);
+    out[1] = static_cast<std::uint8_t>(a1);
+    for (std::size_t i = 0; i < 6; ++i) out[2 + i] = bits >> (i * 8) & 0xff;
+}
+
+//==============================================================================
+// BC7(モード6)
+//==============================================================================
+void QuantizeBC7(const float* e, int p, int* q) {
+    for (std::size_t c = 0; c < 4; ++c) {
+        q[c] = std::clamp<int>(std::lround((e[c] - p) / 2), 0, 127);
+    }
+}
+
+float FitBC7(const float* const* ch, const float* weight, const int* q0, const int* q1, int p0, int p1, std::uint8_t* index) {
+    float palette[16][4];
+    for (std::size_t i = 0; i < 16; ++i) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            auto v0 = q0[c] << 1 | p0;
+            auto v1 = q1[c] << 1 | p1;
+            palette[i][c] = static_cast<float>(((64 - BC7Weights[i]) * v0 + BC7Weights[i] * v1 + 32) >> 6);
+        }
+    }
+    return FindIndices(ch, 4, weight, palette, 16, index);
+}
+
+void EncodeBC7(const Block& block, std::uint8_t* out, CompressQuality quality) {
+    alignas(16) static constexpr float weight[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    static const auto alpha = [] {
+        std::array<float, 16> alpha;
+        for (std::size_t i = 0; i < 16; ++i) alpha[i] = BC7Weights[i] / 64.0f;
+        return alpha;
+    }();
+    const float* ch[4] = {block.r, block.g, block.b, block.a};
+    float mean[4], axis[4], tmin, tmax, e0[4], e1[4];
+    ComputeAxis(ch, 4, weight, mean, axis);
+    ProjectRange(ch, 4, weight, mean, axis, tmin, tmax);
+    for (std::size_t c = 0; c < 4; ++c) {
+        e0[c] = mean[c] + axis[c] * tmin;
+        e1[c] = mean[c] + axis[c] * tmax;
+    }
+    int          q0[4], q1[4], p0 = 0, p1 = 0;
+    std::uint8_t index[16];
+    float        error = std::numeric_limits<float>::max();
+    auto trial = [&](const float* f0, const float* f1, int t0, int t1) {
+        int          r0[4], r1[4];
+        std::uint8_t k[16];
+        QuantizeBC7(f0, t0, r0);
+        QuantizeBC7(f1, t1, r1);
+        auto e = FitBC7(ch, weight, r0, r1, t0, t1, k);
+        if (e < error) {
+            std::copy(r0, r0 + 4, q0);
+            std::copy(r1, r1 + 4, q1);
+            std::copy(k, k + 16, index);
+            p0    = t0;
+            p1    = t1;
+            error = e;
+        }
+    };
+    if (quality == CompressQualityHigh) {
+        for (int t = 0; t < 4; ++t) trial(e0, e1, t & 1, t >> 1);
+        for (int n = 0; n < 2 && error > 0.0f; ++n) {
+            float f0[4], f1[4];
+            if (!FitEndpoints(ch, 4, weight, alpha.data(), index, f0, f1)) break;
+            auto prev = error;
+            for (int t = 0; t < 4; ++t) trial(f0, f1, t & 1, t >> 1);
+            if (error >= prev) break;
+        }
+    } else {
+        // パリティビットは端点の平均値の偶奇で決める
+        auto parity = [](const float* e) {
+            return static_cast<int>(std::lround((e[0] + e[1] + e[2] + e[3]) / 4)) & 1;
+        };
+        trial(e0, e1, parity(e0), parity(e1));
+    }
+    // 先頭ピクセルのインデックス最上位ビットは暗黙的に0
+    if (index[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (auto& i : index) i = 15 - i;
+    }
+    std::uint64_t bits[2] = {};
+    std::size_t   pos     = 0;
+    auto put = [&](std::uint64_t value, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i, ++pos) {
+            bits[pos / 64] |= (value >> i & 1) << (pos % 64);
+        }
+    };
+    put(1 << 6, 7);
+    for (std::size_t c = 0; c < 4; ++c) {
+        put(q0[c], 7);
+        put(q1[c], 7);
+    }
+    put(p0, 1);
+    put(p1, 1);
+    put(index[0], 3);
+    for (std::size_t i = 1; i < 16; ++i) put(index[i], 4);
+    for (std::size_t i = 0; i < 16; ++i) out[i] = bits[i / 8] >> (i % 8 * 8) & 0xff;
+}
+
+} // namespace
+
+SharedImage EncodeImageBCn(const SharedImage image, PixelFormat format, CompressQuality quality) {
+    auto bytes  = Detail::GetBytesPerBlock(format);
+    auto source = image->Format();
+    if (!bytes) {
+        throw std::invalid_argument("EncodeImageBCn: Unsupported format.");
+    }
+    if (image->Rank() > 2 || !Detail::GetBytesPerPixel(source)) {
+        throw std::invalid_argument("EncodeImageBCn: Unsupported image.");
+    }
+    auto width  = image->Length(0);
+    auto height = image->Length(1);
+    auto blockW = (width  + 3) / 4;
+    auto blockH = (height + 3) / 4;
+    // テクスチャの最上位レベルとして使用できるように、サイズはブロック単位に切り上げる
+    auto result = std::make_shared<Detail::ImageBuffer>(format, image->Rank(), blockW * 4, blockH * 4, blockW * bytes);
+    auto src    = static_cast<const std::byte*>(image->Data());
+    auto dst    = result->Buffer();
+    Detail::ParallelFor(blockH, [&](std::size_t by) {
+        std::vector<Detail::rgba_8888> rows(width * 4);
+        for (std::size_t y = 0; y < 4; ++y) {
+            auto sy = std::min(by * 4 + y, height - 1);
+            Detail::ConvertPixelFormat<false>(rows.data() + y * width, RGBA8888, src + sy * image->Stride(), source, width);
+        }
+        for (std::size_t bx = 0; bx < blockW; ++bx) {
+            Block block;
+            for (std::size_t i = 0; i < 16; ++i) {
+                auto& pixel = rows[i / 4 * width + std::min(bx * 4 + i % 4, width - 1)];
+                block.r[i] = pixel.r;
+                block.g[i] = pixel.g;
+                block.b[i] = pixel.b;
+                block.a[i] = pixel.a;
+            }
+            auto out = reinterpret_cast<std::uint8_t*>(dst + by * blockW * bytes + bx * bytes);
+            switch (format) {
+            case BC1UNORM:
+                EncodeColor(block, out, true, quality);
+                break;
+            case BC3UNORM:
+                EncodeSingle(block.a, out);
+                EncodeColor(block, out + 8, false, quality);
+                break;
+            case BC4UNORM:
+                EncodeSingle(block.r, out);
+                break;
+            case BC5UNORM:
+                EncodeSingle(block.r, out);
+                EncodeSingle(block.g, out + 8);
+                break;
+            default:
+                EncodeBC7(block, out, quality);
+                break;
+            }
+        }
+    });
+    return result;
+}
+
+} // namespace Graphene::Graphics
@@ -0,0 +1,151 @@
+/** @file
+ * @brief 画像キャッシュ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/cache.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace Graphene::Graphics {
+
+namespace {
+
+// ファクトリはキャッシュが割り当てた識別番号で比較する
+using Key = std::tuple<std::uint64_t, std::string, PixelFormat, bool>;
+
+using FactoryMap = std::map<std::weak_ptr<Stream::StreamFactory>, std::uint64_t, std::owner_less<>>;
+
+class ImageCacheLRU final : public ImageCache {
+public:
+    ImageCacheLRU(ImageLoader loader, std::size_t budget) :
+    Loader_(std::move(loader)),
+    Budget_(budget),
+    Size_  (0),
+    Sweep_ (MinSweep),
+    NextId_(0) {
+    }
+
+    virtual SharedImage Load(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha) override {
+        std::promise<SharedImage> promise;
+        std::unique_lock<std::mutex> lock(Mutex_);
+        auto it = Entries_.try_emplace(Key(FactoryId(factory), path, format, burnAlpha)).first;
+        if (auto image = it->second.Weak.lock()) {
+            Retain(it->second, image);
+            return image;
+        }
+        if (it->second.Pending.valid()) {
+            auto pending = it->second.Pending;
+            lock.unlock();
+            return pending.get();
+        }
+        it->second.Pending = promise.get_future().share();
+        lock.unlock();
+        SharedImage image;
+        try {
+            image = Loader_(factory->Open(path, "r"), format, burnAlpha);
+        } catch (...) {
+            lock.lock();
+            Entries_.erase(it);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        lock.lock();
+        it->second.Weak    = image;
+        it->second.Pending = {};
+        Retain(it->second, image);
+        promise.set_value(image);
+        return image;
+    }
+
+    virtual std::size_t Size(void) const override {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        return Size_;
+    }
+
+    virtual void Clear(void) override {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        while (!Recent_.empty()) Release(Recent_.back());
+        Sweep();
+    }
+
+private:
+    struct Entry {
+        std::weak_ptr<Image>             Weak;
+        SharedImage                      Retained;
+        std::shared_future<SharedImage>  Pending;
+        std::list<Entry*>::iterator      Position;
+    };
+
+    static constexpr std::size_t MinSweep = 16;
+
+    // 破棄されたファクトリと同じアドレスに作られたファクトリを区別するため、
+    // 制御ブロックで比較して識別番号を割り当てる
+    std::uint64_t FactoryId(const Stream::SharedStreamFactory& factory) {
+        auto [it, inserted] = Factories_.try_emplace(factory, NextId_);
+        if (inserted) ++NextId_;
+        return it->second;
+    }
+
+    // 最近使用した画像として保持し、予算を超えた分を古い順に解放する
+    void Retain(Entry& entry, const SharedImage& image) {
+        if (entry.Retained) {
+            Recent_.splice(Recent_.begin(), Recent_, entry.Position);
+            return;
+        }
+        if (image->Size() > Budget_) return;
+        entry.Retained = image;
+        entry.Position = Recent_.insert(Recent_.begin(), &entry);
+        Size_ += image->Size();
+        while (Size_ > Budget_) Release(Recent_.back());
+        if (Entries_.size() >= Sweep_) Sweep();
+    }
+
+    void Release(Entry* entry) {
+        Size_ -= entry->Retained->Size();
+        Recent_.erase(entry->Position);
+        entry->Retained.reset();
+    }
+
+    // 解放済みの画像のエントリを取り除く
+    void Sweep(void) {
+        for (auto it = Entries_.begin(); it != Entries_.end();) {
+            if (!it->second.Retained && !it->second.Pending.valid() && it->second.Weak.expired()) {
+                it = Entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto it = Factories_.begin(); it != Factories_.end();) {
+            it = it->first.expired() ? Factories_.erase(it) : std::next(it);
+        }
+        Sweep_ = std::max(Entries_.size() * 2, MinSweep);
+    }
+
+private:
+    mutable std::mutex   Mutex_;
+    ImageLoader          Loader_;
+    std::size_t          Budget_;
+    std::size_t          Size_;
+    std::size_t          Sweep_;
+    std::uint64_t        NextId_;
+    std::map<Key, Entry> Entries_;
+    std::list<Entry*>    Recent_;
+    FactoryMap           Factories_;
+};
+
+} // namespace
+
+SharedImageCache CreateImageCache(ImageLoader loader, std::size_t budget) {
+    return std::make_shared<ImageCacheLRU>(std::move(loader), budget);
+}
+
+} // namespace Graphene::Graphics
@@ -0,0 +1,186 @@
+/** @file
+ * @brief 画像ディスクキャッシュ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/diskcache.hpp>
+#include <graphene/graphics/image/gtc.hpp>
+#include <graphene/stream/checksum.hpp>
+#include <graphene/stream/file.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Graphene::Graphics {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::size_t HashChunk = 64 * 1024;
+constexpr char        Extension[] = ".gtc";
+
+class ImageDiskCacheGTC final : public ImageDiskCache {
+public:
+    ImageDiskCacheGTC(ImageLoader loader, const std::string& directory, std::size_t budget, CacheValidation validation) :
+    Loader_    (std::move(loader)),
+    Directory_ (directory),
+    Budget_    (budget),
+    Validation_(validation),
+    Size_      (0),
+    Serial_    (0) {
+        fs::create_directories(Directory_);
+        for (auto& file : List()) Size_ += file.Size;
+    }
+
+    virtual SharedImage Load(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha) override {
+        auto stream = factory->Open(path, "r");
+        auto name   = Directory_ / Name(factory, stream, path, format, burnAlpha);
+        std::error_code ec;
+        if (fs::exists(name, ec)) {
+            try {
+                auto image = MapImageGTC(name.string());
+                fs::last_write_time(name, fs::file_time_type::clock::now(), ec);
+                return image;
+            } catch (const std::exception&) {
+                Remove(name);
+            }
+        }
+        auto image = Loader_(stream, format, burnAlpha);
+        Store(name, image);
+        return image;
+    }
+
+    virtual std::size_t Size(void) const override {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        return Size_;
+    }
+
+    virtual void Clear(void) override {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        for (auto& file : List()) Remove(file.Path, file.Size);
+    }
+
+private:
+    struct File {
+        fs::path            Path;
+        std::size_t         Size;
+        fs::file_time_type  Time;
+    };
+
+    // ソースの識別値からキャッシュファイル名を生成する
+    // パスがローカルのファイルを指すのはFileFactoryの場合のみ
+    fs::path Name(Stream::SharedStreamFactory factory, Stream::SharedStream stream, const std::string& path, PixelFormat format, bool burnAlpha) const {
+        std::uint64_t key = 0;
+        std::error_code ec;
+        auto local  = Validation_ == CacheValidationTime && dynamic_cast<Stream::FileFactory*>(factory.get());
+        auto source = local ? fs::absolute(path, ec) : fs::path();
+        if (local && fs::is_regular_file(fs::status(source, ec))) {
+            auto time = fs::last_write_time(source, ec).time_since_epoch().count();
+            auto size = fs::file_size(source, ec);
+            Stream::XXH64 hash;
+            hash.Update(source.string().data(), source.string().size());
+            hash.Update(&time, sizeof(time));
+            hash.Update(&size, sizeof(size));
+            key = hash.Digest();
+        } else {
+            auto origin = stream->Tell();
+            Stream::XXH64 hash;
+            std::vector<char> chunk(HashChunk);
+            while (auto size = stream->Read(chunk.data(), chunk.size())) hash.Update(chunk.data(), size);
+            if (!stream->Seek(origin)) {
+                throw std::runtime_error("ImageDiskCache: Failed to rewind stream.");
+            }
+            key = hash.Digest();
+        }
+        char name[64];
+        std::snprintf(name, sizeof(name), "%016llx-%02x%c%s", static_cast<unsigned long long>(key), format, burnAlpha ? 'p' : 's', Extension);
+        return name;
+    }
+
+    // 一時ファイルに書き込んでから置き換える
+    void Store(const fs::path& name, const SharedImage image) {
+        if (image->Size() > Budget_) return;
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), ".%zx.%zu.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()), Serial_++);
+        auto temp = name;
+        temp += suffix;
+        std::error_code ec;
+        try {
+            Stream::FileFactory factory;
+            auto stream = factory.Open(temp.string(), "w");
+            SaveImageGTC(stream, image);
+            if (!stream->Flush()) throw std::runtime_error("ImageDiskCache: Failed to flush stream.");
+            stream->Close();
+        } catch (const std::exception&) {
+            fs::remove(temp, ec);
+            return;
+        }
+        auto size = fs::file_size(temp, ec);
+        std::lock_guard<std::mutex> lock(Mutex_);
+        auto replaced = fs::exists(name, ec) ? fs::file_size(name, ec) : 0;
+        fs::rename(temp, name, ec);
+        if (ec) {
+            fs::remove(temp, ec);
+            return;
+        }
+        Size_ += size - std::min<std::size_t>(replaced, Size_);
+        if (Size_ > Budget_) Evict();
+    }
+
+    // 予算の3/4になるまで古いファイルを削除する
+    void Evict(void) {
+        auto files = List();
+        std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.Time < b.Time; });
+        Size_ = 0;
+        for (auto& file : files) Size_ += file.Size;
+        for (auto& file : files) {
+            if (Size_ <= Budget_ / 4 * 3) break;
+            Remove(file.Path, file.Size);
+        }
+    }
+
+    std::vector<File> List(void) const {
+        std::vector<File> files;
+        std::error_code ec;
+        for (auto& entry : fs::directory_iterator(Directory_, ec)) {
+            if (!entry.is_regular_file(ec) || entry.path().extension() != Extension) continue;
+            files.push_back({entry.path(), static_cast<std::size_t>(entry.file_size(ec)), entry.last_write_time(ec)});
+        }
+        return files;
+    }
+
+    void Remove(const fs::path& path) {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        std::error_code ec;
+        Remove(path, fs::file_size(path, ec));
+    }
+
+    void Remove(const fs::path& path, std::size_t size) {
+        std::error_code ec;
+        if (fs::remove(path, ec)) Size_ -= std::min(size, Size_);
+    }
+
+private:
+    mutable std::mutex       Mutex_;
+    ImageLoader              Loader_;
+    fs::path                 Directory_;
+    std::size_t              Budget_;
+    CacheValidation          Validation_;
+    std::size_t              Size_;
+    std::atomic<std::size_t> Serial_;
+};
+
+} // namespace
+
+SharedImageDiskCache CreateImageDiskCache(ImageLoader loader, const std::string& directory, std::size_t budget, CacheValidation validation) {
+    return std::make_shared<ImageDiskCacheGTC>(std::move(loader), directory, budget, validation);
+}
+
+} // namespace Graphene::Graphics
@@ -0,0 +1,235 @@
+/** @file
+ * @brief GTCテクスチャコンテナ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/gtc.hpp>
+#include <graphene/stream/mapped.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "../detail/pixconv.hpp"
+#include "../../stream/detail/mapping.hpp"
+
+namespace Graphene::Graphics {
+
+namespace {
+
+// ファイル構造(リトルエンディアン)
+//   0: マジックナンバー "GTC\x1a"
+//   4: バージョン                     (4 bytes)
+//   8: ピクセルフォーマット           (4 bytes)
+//  12: 次元数                         (4 bytes)
+//  16: 各軸長                         (4 bytes x 3)
+//  28: ミップレベル数                 (4 bytes)
+//  32: レベルテーブル                 (オフセット,行間隔,サイズ: 8 bytes x 3) x ミップレベル数
+//  以降: 256バイト境界に配置した各レベルのピクセルデータ
+constexpr char          Magic[4]   = {'G', 'T', 'C', '\x1a'};
+constexpr std::uint32_t Version    = 1;
+constexpr std::size_t   HeaderSize = 32;
+constexpr std::size_t   LevelSize  = 24;
+constexpr std::size_t   DataAlign  = 256;
+constexpr std::size_t   MaxLevels  = 32;
+
+struct LevelInfo {
+    std::size_t Offset;
+    std::size_t Stride;
+    std::size_t Size;
+};
+
+struct Layout {
+    PixelFormat Format;
+    std::size_t Rank;
+    std::size_t Length[3];
+    std::size_t Levels;
+    LevelInfo   Level[MaxLevels];
+};
+
+std::uint64_t Get(const std::byte* data, std::size_t n) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < n; ++i) value |= static_cast<std::uint64_t>(data[i]) << (i * 8);
+    return value;
+}
+
+void Put(std::byte* data, std::uint64_t value, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) data[i] = static_cast<std::byte>(value >> (i * 8));
+}
+
+Layout Parse(const std::byte* data, std::size_t size) {
+    if (size < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("LoadImageGTC: Invalid signature.");
+    }
+    if (Get(data + 4, 4) != Version) {
+        throw std::runtime_error("LoadImageGTC: Unsupported version.");
+    }
+    Layout layout;
+    layout.Format = static_cast<PixelFormat>(Get(data + 8, 4));
+    layout.Rank   = Get(data + 12, 4);
+    layout.Levels = Get(data + 28, 4);
+    for (std::size_t i = 0; i < 3; ++i) {
+        layout.Length[i] = Get(data + 16 + i * 4, 4);
+    }
+    if (!Detail::GetBytesPerPixel(layout.Format) && !Detail::GetBytesPerBlock(layout.Format)) {
+        throw std::runtime_error("LoadImageGTC: Unexpected format.");
+    }
+    if (layout.Rank < 1 || layout.Rank > 3 || layout.Levels < 1 || layout.Levels > MaxLevels) {
+        throw std::runtime_error("LoadImageGTC: Broken header.");
+    }
+    if (size < HeaderSize + LevelSize * layout.Levels) {
+        throw std::runtime_error("LoadImageGTC: Broken header.");
+    }
+    for (std::size_t i = layout.Rank; i < 3; ++i) layout.Length[i] = 1;
+    for (std::size_t i = 0; i < layout.Levels; ++i) {
+        auto entry  = data + HeaderSize + LevelSize * i;
+        auto& level = layout.Level[i];
+        level.Offset = Get(entry,      8);
+        level.Stride = Get(entry +  8, 8);
+        level.Size   = Get(entry + 16, 8);
+        auto width  = std::max<std::size_t>(layout.Length[0] >> i, 1);
+        auto height = std::max<std::size_t>(layout.Length[1] >> i, 1);
+        auto depth  = std::max<std::size_t>(layout.Length[2] >> i, 1);
+        if (level.Stride < Detail::GetBytesPerRow(layout.Format, width) ||
+            level.Size / level.Stride < Detail::GetRowCount(layout.Format, height) * depth ||
+            level.Offset > size || level.Size > size - level.Offset) {
+            throw std::runtime_error("LoadImageGTC: Broken level table.");
+        }
+    }
+    return layout;
+}
+
+class ImageGTC final : public Image {
+public:
+    ImageGTC(std::shared_ptr<const void> owner, const std::byte* data, std::size_t size) :
+    Owner_ (owner),
+    Data_  (data),
+    Layout_(Parse(data, size)) {
+    }
+
+    virtual const void* Data(void) const override {
+        return Data_ + Layout_.Level[0].Offset;
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Layout_.Level[0].Size;
+    }
+
+    virtual std::size_t Rank(void) const override {
+        return Layout_.Rank;
+    }
+
+    virtual std::size_t Length(std::size_t axis) const override {
+        return Layout_.Rank > axis ? Layout_.Length[axis] : 1;
+    }
+
+    virtual std::size_t Stride(void) const override {
+        return Layout_.Level[0].Stride;
+    }
+
+    virtual PixelFormat Format(void) const override {
+        return Layout_.Format;
+    }
+
+    virtual std::size_t Levels(void) const override {
+        return Layout_.Levels;
+    }
+
+    virtual std::size_t LevelOffset(std::size_t level) const override {
+        return Layout_.Level[level].Offset - Layout_.Level[0].Offset;
+    }
+
+    virtual std::size_t LevelStride(std::size_t level) const override {
+        return Layout_.Level[level].Stride;
+    }
+
+private:
+    std::shared_ptr<const void> Owner_;
+    const std::byte*            Data_;
+    Layout                      Layout_;
+};
+
+} // namespace
+
+SharedImage LoadImageGTC(Stream::SharedStream stream) {
+    if (auto mapped = dynamic_cast<Stream::MappedStream*>(stream.get())) {
+        auto mapping = mapped->Mapping().subspan(std::min(stream->Tell(), mapped->Mapping().size()));
+        auto image   = std::make_shared<ImageGTC>(stream, mapping.data(), mapping.size());
+        stream->Seek(stream->Size());
+        return image;
+    }
+    auto size   = stream->Size() - stream->Tell();
+    auto buffer = std::make_shared<std::vector<std::byte>>(size);
+    if (stream->Read(buffer->data(), size) < size) {
+        throw std::runtime_error("LoadImageGTC: Failed to read stream.");
+    }
+    return std::make_shared<ImageGTC>(buffer, buffer->data(), buffer->size());
+}
+
+SharedImage MapImageGTC(const std::string& path) {
+    auto mapping = std::make_shared<Stream::Detail::FileMapping>(path);
+    return std::make_shared<ImageGTC>(mapping, mapping->Data(), mapping->Size());
+}
+
+void SaveImageGTC(Stream::SharedStream stream, const SharedImage image) {
+    auto format = image->Format();
+    auto rank   = image->Rank();
+    if (!Detail::GetBytesPerPixel(format) && !Detail::GetBytesPerBlock(format)) {
+        throw std::invalid_argument("SaveImageGTC: Unsupported format.");
+    }
+    if (rank < 1 || rank > 3 || image->Levels() > MaxLevels) {
+        throw std::invalid_argument("SaveImageGTC: Unsupported image.");
+    }
+    auto write = [&stream](const void* data, std::size_t size) {
+        if (stream->Write(data, size) < size) {
+            throw std::runtime_error("SaveImageGTC: Failed to write stream.");
+        }
+    };
+    auto levels = image->Levels();
+    auto offset = (HeaderSize + LevelSize * levels + DataAlign - 1) / DataAlign * DataAlign;
+    std::vector<std::byte> header(offset);
+    std::memcpy(header.data(), Magic, sizeof(Magic));
+    Put(header.data() +  4, Version, 4);
+    Put(header.data() +  8, format,  4);
+    Put(header.data() + 12, rank,    4);
+    for (std::size_t i = 0; i < 3; ++i) {
+        Put(header.data() + 16 + i * 4, image->Length(i), 4);
+    }
+    Put(header.data() + 28, levels, 4);
+    std::vector<LevelInfo> table(levels);
+    for (std::size_t i = 0; i < levels; ++i) {
+        auto width  = std::max<std::size_t>(image->Length(0) >> i, 1);
+        auto height = std::max<std::size_t>(image->Length(1) >> i, 1);
+        auto depth  = std::max<std::size_t>(image->Length(2) >> i, 1);
+        auto stride = (Detail::GetBytesPerRow(format, width) + 3) & ~std::size_t(3); // align to 4 bytes
+        table[i] = {offset, stride, stride * Detail::GetRowCount(format, height) * depth};
+        offset   = (offset + table[i].Size + DataAlign - 1) / DataAlign * DataAlign;
+        auto entry = header.data() + HeaderSize + LevelSize * i;
+        Put(entry,      table[i].Offset, 8);
+        Put(entry +  8, table[i].Stride, 8);
+        Put(entry + 16, table[i].Size,   8);
+    }
+    write(header.data(), header.size());
+    auto position = header.size();
+    for (std::size_t i = 0; i < levels; ++i) {
+        const std::byte padding[DataAlign] = {};
+        write(padding, table[i].Offset - position);
+        auto data     = static_cast<const std::byte*>(image->Data()) + image->LevelOffset(i);
+        auto stride   = image->LevelStride(i);
+        auto rowBytes = Detail::GetBytesPerRow(format, std::max<std::size_t>(image->Length(0) >> i, 1));
+        auto rowCount = table[i].Size / table[i].Stride;
+        if (stride == table[i].Stride && (i || image->Size() >= table[i].Size)) {
+            write(data, table[i].Size);
+        } else {
+            for (std::size_t y = 0; y < rowCount; ++y) {
+                write(data + y * stride, rowBytes);
+                write(padding, table[i].Stride - rowBytes);
+            }
+        }
+        position = table[i].Offset + table[i].Size;
+    }
+}
+
+} // namespace Graphene::Graphics
@@ -0,0 +1,203 @@
+/** @file
+ * @brief 遅延読み込み画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/lazy.hpp>
+#include <graphene/graphics/image/gtc.hpp>
+#include <graphene/graphics/image/png.hpp>
+#include <graphene/graphics/image/qoi.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../detail/pixconv.hpp"
+#include "../../stream/detail/workers.hpp"
+#include "../../config.hpp"
+
+namespace Graphene::Graphics {
+
+namespace {
+
+enum SourceType {
+    SourceTypePNG,
+    SourceTypeQOI,
+    SourceTypeGTC
+};
+
+struct Header {
+    SourceType  Type;
+    PixelFormat Format;
+    std::size_t Rank;
+    std::size_t Length[3];
+};
+
+constexpr std::size_t HeaderSize = 32;
+
+std::uint32_t GetBE32(const std::uint8_t* data) {
+    return static_cast<std::uint32_t>(data[0]) << 24 | data[1] << 16 | data[2] << 8 | data[3];
+}
+
+std::uint32_t GetLE32(const std::uint8_t* data) {
+    return static_cast<std::uint32_t>(data[3]) << 24 | data[2] << 16 | data[1] << 8 | data[0];
+}
+
+// ヘッダからソースの種類と変換後の形状を求める
+Header ReadHeader(Stream::SharedStream stream, PixelFormat format) {
+    std::vector<std::byte> buffer;
+    auto view = stream->Peek(HeaderSize, buffer);
+    auto data = reinterpret_cast<const std::uint8_t*>(view.data());
+    auto size = view.size();
+    if (size >= 25 && std::memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0 && std::memcmp(data + 12, "IHDR", 4) == 0) {
+        auto source = data[24] == 16 ? RGBAUN16 : RGBA8888;
+        return {SourceTypePNG, Detail::GetConvertibleFormat(format, source), 2, {GetBE32(data + 16), GetBE32(data + 20), 1}};
+    }
+    if (size >= 14 && std::memcmp(data, "qoif", 4) == 0) {
+        return {SourceTypeQOI, Detail::GetConvertibleFormat(format, RGBA8888), 2, {GetBE32(data + 4), GetBE32(data + 8), 1}};
+    }
+    if (size >= 32 && std::memcmp(data, "GTC\x1a", 4) == 0) {
+        auto rank = GetLE32(data + 12);
+        return {SourceTypeGTC, static_cast<PixelFormat>(GetLE32(data + 8)), rank, {GetLE32(data + 16), GetLE32(data + 20), GetLE32(data + 24)}};
+    }
+    throw std::runtime_error("LazyImage: Unknown image type.");
+}
+
+// 先行読み込みは全ての画像で共有するワーカーでデコードする
+Stream::Detail::WorkerPool& Workers(void) {
+    static Stream::Detail::WorkerPool workers(std::thread::hardware_concurrency());
+    return workers;
+}
+
+class ImageLazy final : public LazyImage, public std::enable_shared_from_this<ImageLazy> {
+public:
+    ImageLazy(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha) :
+    Factory_  (factory),
+    Path_     (path),
+    Format_   (format),
+    BurnAlpha_(burnAlpha),
+    Started_  (false),
+    Claimed_  (false) {
+    }
+
+    virtual const void* Data(void) const override {
+        return Get()->Data();
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Get()->Size();
+    }
+
+    virtual std::size_t Rank(void) const override {
+        return GetHeader().Rank;
+    }
+
+    virtual std::size_t Length(std::size_t axis) const override {
+        return GetHeader().Rank > axis ? GetHeader().Length[axis] : 1;
+    }
+
+    virtual std::size_t Stride(void) const override {
+        return Get()->Stride();
+    }
+
+    virtual PixelFormat Format(void) const override {
+        return GetHeader().Format;
+    }
+
+    virtual std::size_t Levels(void) const override {
+        return Get()->Levels();
+    }
+
+    virtual std::size_t LevelOffset(std::size_t level) const override {
+        return Get()->LevelOffset(level);
+    }
+
+    virtual std::size_t LevelStride(std::size_t level) const override {
+        return Get()->LevelStride(level);
+    }
+
+    // キューで待機中に画像が破棄された場合はデコードしない
+    virtual void Prefetch(void) override {
+        if (!Start()) return;
+        Workers().Submit([weak = weak_from_this()] {
+            if (auto self = weak.lock()) self->Run();
+        });
+    }
+
+    virtual bool Loaded(void) const override {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        return Image_.valid() && Image_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+private:
+    const Header& GetHeader(void) const {
+        std::call_once(HeaderOnce_, [this] { Header_ = ReadHeader(Factory_->Open(Path_, "r"), Format_); });
+        return Header_;
+    }
+
+    // 先行読み込みがまだ開始していない場合は呼び出し元のスレッドでデコードする
+    const SharedImage& Get(void) const {
+        Start();
+        Run();
+        return Image_.get();
+    }
+
+    // 初回のみtrueを返す
+    bool Start(void) const {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        if (Started_) return false;
+        Started_ = true;
+        Image_   = Promise_.get_future().share();
+        return true;
+    }
+
+    // ワーカーと呼び出し元のうち先に実行した方だけがデコードする
+    void Run(void) const {
+        if (Claimed_.exchange(true)) return;
+        try {
+            Promise_.set_value(Decode(Factory_, Path_, Format_, BurnAlpha_));
+        } catch (...) {
+            Promise_.set_exception(std::current_exception());
+        }
+    }
+
+    static SharedImage Decode(Stream::SharedStreamFactory factory, std::string path, PixelFormat format, bool burnAlpha) {
+        auto stream = factory->Open(path, "r");
+        auto header = ReadHeader(stream, format);
+        switch (header.Type) {
+#if USE_LIBPNG
+        case SourceTypePNG: return LoadImagePNG(stream, format, burnAlpha);
+#endif
+        case SourceTypeQOI: return LoadImageQOI(stream, format, burnAlpha);
+        case SourceTypeGTC: return LoadImageGTC(stream);
+        default: throw std::runtime_error("LazyImage: Unsupported image type.");
+        }
+    }
+
+private:
+    mutable std::mutex                      Mutex_;
+    mutable std::once_flag                  HeaderOnce_;
+    mutable Header                          Header_;
+    mutable std::shared_future<SharedImage> Image_;
+    mutable std::promise<SharedImage>       Promise_;
+    Stream::SharedStreamFactory             Factory_;
+    std::string                             Path_;
+    PixelFormat                             Format_;
+    bool                                    BurnAlpha_;
+    mutable bool                            Started_;
+    mutable std::atomic<bool>               Claimed_;
+};
+
+} // namespace
+
+SharedLazyImage CreateLazyImage(Stream::SharedStreamFactory factory, const std::string& path, PixelFormat format, bool burnAlpha) {
+    return std::make_shared<ImageLazy>(factory, path, format, burnAlpha);
+}
+
+} // namespace Graphene::Graphics
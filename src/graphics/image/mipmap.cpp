@@ -0,0 +1,292 @@
+/** @file
+ * @brief ミップマップ生成
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/mipmap.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "../detail/parallel.hpp"
+#include "../detail/pixconv.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Graphene::Graphics {
+
+namespace {
+
+constexpr std::size_t MaxLevels         = 32;
+constexpr std::size_t LevelAlign        = 16;
+constexpr std::size_t ParallelThreshold = 256 * 256; // 並列処理するレベルの最小ピクセル数
+constexpr int         KaiserTaps        = 6;
+
+// RGBAの4要素を1組として演算する
+struct Vec4 {
+#if defined(__SSE2__)
+    __m128 V;
+    static Vec4 Load(const float* p)          { return {_mm_loadu_ps(p)}; }
+    static Vec4 Zero(void)                    { return {_mm_setzero_ps()}; }
+    void        Store(float* p) const         { _mm_storeu_ps(p, V); }
+    Vec4        operator+(const Vec4& o) const { return {_mm_add_ps(V, o.V)}; }
+    Vec4        operator*(float s) const       { return {_mm_mul_ps(V, _mm_set1_ps(s))}; }
+#else
+    float V[4];
+    static Vec4 Load(const float* p)          { return {{p[0], p[1], p[2], p[3]}}; }
+    static Vec4 Zero(void)                    { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+    void        Store(float* p) const         { std::copy(V, V + 4, p); }
+    Vec4        operator+(const Vec4& o) const { return {{V[0] + o.V[0], V[1] + o.V[1], V[2] + o.V[2], V[3] + o.V[3]}}; }
+    Vec4        operator*(float s) const       { return {{V[0] * s, V[1] * s, V[2] * s, V[3] * s}}; }
+#endif
+};
+
+// 線形空間で保持する浮動小数点数の画像(RGBA,乗算済みアルファ)
+struct Plane {
+    std::size_t        Width;
+    std::size_t        Height;
+    std::vector<float> Pixels;
+
+    Plane(std::size_t width, std::size_t height) :
+    Width (width),
+    Height(height),
+    Pixels(width * height * 4) {
+    }
+
+    float* Row(std::size_t y) {
+        return Pixels.data() + y * Width * 4;
+    }
+
+    const float* Row(std::size_t y) const {
+        return Pixels.data() + y * Width * 4;
+    }
+};
+
+template<class F>
+void ForEachRow(std::size_t rows, std::size_t pixels, F&& func) {
+    if (pixels >= ParallelThreshold) {
+        Detail::ParallelFor(rows, func);
+    } else {
+        for (std::size_t y = 0; y < rows; ++y) func(y);
+    }
+}
+
+float ToLinear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float ToGamma(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+// sinc関数にカイザー窓を掛けた2:1縮小用のカーネル
+const float* KaiserKernel(void) {
+    static const auto kernel = [] {
+        auto bessel = [](double x) {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 16; ++k) {
+                term *= (x / (2 * k)) * (x / (2 * k));
+                sum  += term;
+            }
+            return sum;
+        };
+        constexpr double pi = 3.14159265358979323846, beta = 4.0, radius = KaiserTaps / 2;
+        std::vector<float> kernel(KaiserTaps);
+        double total = 0.0;
+        for (int i = 0; i < KaiserTaps; ++i) {
+            auto d    = i - (KaiserTaps - 1) / 2.0;
+            auto x    = pi * d / 2;
+            auto sinc = x == 0.0 ? 1.0 : std::sin(x) / x;
+            auto r    = d / radius;
+            kernel[i] = static_cast<float>(sinc * bessel(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel(beta));
+            total    += kernel[i];
+        }
+        for (auto& k : kernel) k = static_cast<float>(k / total);
+        return kernel;
+    }();
+    return kernel.data();
+}
+
+void DownsampleBox(const Plane& src, Plane& dst) {
+    ForEachRow(dst.Height, dst.Width * dst.Height, [&](std::size_t y) {
+        auto row0 = src.Row(std::min(y * 2,     src.Height - 1));
+        auto row1 = src.Row(std::min(y * 2 + 1, src.Height - 1));
+        auto out  = dst.Row(y);
+        for (std::size_t x = 0; x < dst.Width; ++x) {
+            auto x0 = std::min(x * 2,     src.Width - 1) * 4;
+            auto x1 = std::min(x * 2 + 1, src.Width - 1) * 4;
+            auto v  = Vec4::Load(row0 + x0) + Vec4::Load(row0 + x1) + Vec4::Load(row1 + x0) + Vec4::Load(row1 + x1);
+            (v * 0.25f).Store(out + x * 4);
+        }
+    });
+}
+
+void DownsampleKaiser(const Plane& src, Plane& dst) {
+    auto kernel = KaiserKernel();
+    auto offset = static_cast<std::ptrdiff_t>(KaiserTaps / 2 - 1);
+    auto clamp  = [](std::ptrdiff_t i, std::size_t n) {
+        return static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(i, 0, n - 1));
+    };
+    // 横方向
+    Plane temp(dst.Width, src.Height);
+    ForEachRow(temp.Height, src.Width * src.Height, [&](std::size_t y) {
+        auto in  = src.Row(y);
+        auto out = temp.Row(y);
+        for (std::size_t x = 0; x < temp.Width; ++x) {
+            if (src.Width == 1) {
+                Vec4::Load(in).Store(out);
+                continue;
+            }
+            auto v = Vec4::Zero();
+            for (int k = 0; k < KaiserTaps; ++k) {
+                v = v + Vec4::Load(in + clamp(static_cast<std::ptrdiff_t>(x * 2) - offset + k, src.Width) * 4) * kernel[k];
+            }
+            v.Store(out + x * 4);
+        }
+    });
+    // 縦方向
+    ForEachRow(dst.Height, temp.Width * temp.Height, [&](std::size_t y) {
+        auto out = dst.Row(y);
+        if (temp.Height == 1) {
+            std::copy(temp.Row(0), temp.Row(0) + temp.Width * 4, out);
+            return;
+        }
+        const float* rows[KaiserTaps];
+        for (int k = 0; k < KaiserTaps; ++k) {
+            rows[k] = temp.Row(clamp(static_cast<std::ptrdiff_t>(y * 2) - offset + k, temp.Height));
+        }
+        for (std::size_t x = 0; x < dst.Width * 4; x += 4) {
+            auto v = Vec4::Zero();
+            for (int k = 0; k < KaiserTaps; ++k) v = v + Vec4::Load(rows[k] + x) * kernel[k];
+            v.Store(out + x);
+        }
+    });
+}
+
+class ImageMipmap final : public Image {
+public:
+    ImageMipmap(PixelFormat format, std::size_t rank, std::size_t width, std::size_t height) :
+    Rank_  (rank),
+    Length_{width, height},
+    Levels_(0),
+    Format_(format) {
+        auto bytes = Detail::GetBytesPerPixel(format);
+        auto total = std::size_t(0);
+        for (auto size = std::max(width, height); size; size >>= 1) {
+            auto w = std::max<std::size_t>(width  >> Levels_, 1);
+            auto h = std::max<std::size_t>(height >> Levels_, 1);
+            Offset_[Levels_] = total;
+            Stride_[Levels_] = (bytes * w + 3) & ~std::size_t(3); // align to 4 bytes
+            total += (Stride_[Levels_] * h + LevelAlign - 1) / LevelAlign * LevelAlign;
+            ++Levels_;
+        }
+        Image_.resize(total);
+    }
+
+    virtual const void* Data(void) const override {
+        return Image_.data();
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Stride_[0] * Length_[1];
+    }
+
+    virtual std::size_t Rank(void) const override {
+        return Rank_;
+    }
+
+    virtual std::size_t Length(std::size_t axis) const override {
+        return Rank_ > axis ? Length_[axis] : 1;
+    }
+
+    virtual std::size_t Stride(void) const override {
+        return Stride_[0];
+    }
+
+    virtual PixelFormat Format(void) const override {
+        return Format_;
+    }
+
+    virtual std::size_t Levels(void) const override {
+        return Levels_;
+    }
+
+    virtual std::size_t LevelOffset(std::size_t level) const override {
+        return Offset_[level];
+    }
+
+    virtual std::size_t LevelStride(std::size_t level) const override {
+        return Stride_[level];
+    }
+
+    std::byte* Buffer(std::size_t level) noexcept {
+        return Image_.data() + Offset_[level];
+    }
+
+private:
+    std::vector<std::byte> Image_;
+    std::size_t            Rank_;
+    std::size_t            Length_[2];
+    std::size_t            Levels_;
+    std::size_t            Offset_[MaxLevels];
+    std::size_t            Stride_[MaxLevels];
+    PixelFormat            Format_;
+};
+
+} // namespace
+
+SharedImage GenerateMipmaps(const SharedImage image, MipmapFilter filter, bool gamma, bool premultiplied) {
+    auto format = image->Format();
+    if (image->Rank() > 2 || !Detail::GetBytesPerPixel(format)) {
+        throw std::invalid_argument("GenerateMipmaps: Unsupported image.");
+    }
+    auto width  = image->Length(0);
+    auto height = image->Length(1);
+    if (!width || !height) {
+        throw std::invalid_argument("GenerateMipmaps: Empty image.");
+    }
+    auto result = std::make_shared<ImageMipmap>(format, image->Rank(), width, height);
+    auto src    = static_cast<const std::byte*>(image->Data());
+    auto bytes  = Detail::GetBytesPerPixel(format) * width;
+    for (std::size_t y = 0; y < height; ++y) {
+        std::memcpy(result->Buffer(0) + y * result->LevelStride(0), src + y * image->Stride(), bytes);
+    }
+    Plane plane(width, height);
+    ForEachRow(height, width * height, [&](std::size_t y) {
+        auto row = plane.Row(y);
+        Detail::ConvertPixelFormat<false>(row, RGBAFP32, src + y * image->Stride(), format, width);
+        for (std::size_t x = 0; x < width * 4; x += 4) {
+            auto a = premultiplied ? 1.0f : row[x + 3];
+            for (std::size_t c = 0; c < 3; ++c) {
+                row[x + c] = (gamma ? ToLinear(row[x + c]) : row[x + c]) * a;
+            }
+        }
+    });
+    for (std::size_t level = 1; level < result->Levels(); ++level) {
+        Plane next(std::max<std::size_t>(width >> level, 1), std::max<std::size_t>(height >> level, 1));
+        if (filter == MipmapFilterKaiser) DownsampleKaiser(plane, next);
+        else                              DownsampleBox   (plane, next);
+        plane = std::move(next);
+        ForEachRow(plane.Height, plane.Width * plane.Height, [&](std::size_t y) {
+            std::vector<float> row(plane.Row(y), plane.Row(y) + plane.Width * 4);
+            for (std::size_t x = 0; x < plane.Width * 4; x += 4) {
+                auto a = std::clamp(row[x + 3], 0.0f, 1.0f);
+                for (std::size_t c = 0; c < 3; ++c) {
+                    auto v = premultiplied ? row[x + c] : a > 0.0f ? row[x + c] / a : 0.0f;
+                    row[x + c] = gamma ? ToGamma(std::clamp(v, 0.0f, 1.0f)) : v;
+                }
+                row[x + 3] = a;
+            }
+            auto dst = result->Buffer(level) + y * result->LevelStride(level);
+            Detail::ConvertPixelFormat<false>(dst, format, row.data(), RGBAFP32, plane.Width);
+        });
+    }
+    return result;
+}
+
+} // namespace Graphene::Graphics
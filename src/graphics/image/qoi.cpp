@@ -0,0 +1,199 @@
+/** @file
+ * @brief QOI画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/qoi.hpp>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "../detail/imgbuf.hpp"
+#include "../detail/pixconv.hpp"
+
+namespace Graphene::Graphics {
+
+namespace {
+
+constexpr std::uint8_t OpIndex = 0x00;
+constexpr std::uint8_t OpDiff  = 0x40;
+constexpr std::uint8_t OpLuma  = 0x80;
+constexpr std::uint8_t OpRun   = 0xc0;
+constexpr std::uint8_t OpRGB   = 0xfe;
+constexpr std::uint8_t OpRGBA  = 0xff;
+constexpr std::uint8_t OpMask  = 0xc0;
+
+constexpr char         Magic[4]    = {'q', 'o', 'i', 'f'};
+constexpr std::uint8_t Padding[8]  = {0, 0, 0, 0, 0, 0, 0, 1};
+constexpr std::size_t  HeaderSize  = 14;
+constexpr std::size_t  MaxPixels   = 400000000;
+
+std::size_t Hash(const std::uint8_t* px) {
+    return (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+}
+
+std::uint32_t GetBE32(const std::uint8_t* data) {
+    return static_cast<std::uint32_t>(data[0]) << 24 | data[1] << 16 | data[2] << 8 | data[3];
+}
+
+void PutBE32(std::vector<std::uint8_t>& data, std::uint32_t value) {
+    data.push_back(value >> 24 & 0xff);
+    data.push_back(value >> 16 & 0xff);
+    data.push_back(value >>  8 & 0xff);
+    data.push_back(value       & 0xff);
+}
+
+} // namespace
+
+SharedImage LoadImageQOI(Stream::SharedStream stream, PixelFormat format, bool burnAlpha) {
+    // マップされたストリームはコピーせずに参照し、それ以外は読み込む
+    auto size = stream->Size() - stream->Tell();
+    std::vector<std::byte> buffer;
+    auto view = stream->Peek(size, buffer);
+    if (view.size() < size) {
+        throw std::runtime_error("LoadImageQOI: Failed to read qoi stream.");
+    }
+    auto data = reinterpret_cast<const std::uint8_t*>(view.data());
+    if (size < HeaderSize + sizeof(Padding) || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("LoadImageQOI: Invalid signature.");
+    }
+    std::size_t width    = GetBE32(data + 4);
+    std::size_t height   = GetBE32(data + 8);
+    std::size_t channels = data[12];
+    if (!width || !height || channels < 3 || channels > 4 || height > MaxPixels / width) {
+        throw std::runtime_error("LoadImageQOI: Broken header.");
+    }
+    format = Detail::GetConvertibleFormat(format, RGBA8888);
+    if (!Detail::GetBytesPerPixel(format)) {
+        throw std::logic_error("LoadImageQOI: Unsupported conversion patterns.");
+    }
+    auto stride = (Detail::GetBytesPerPixel(format) * width + 3) & ~std::size_t(3); // align to 4 bytes
+    auto image  = std::make_shared<Detail::ImageBuffer>(format, 2, width, height, stride);
+    auto direct = format == RGBA8888 && !burnAlpha;
+    std::vector<std::uint8_t> row(direct ? 0 : width * 4);
+    std::uint8_t index[64][4] = {};
+    std::uint8_t px[4]        = {0, 0, 0, 255};
+    std::size_t  pos = HeaderSize, end = size - sizeof(Padding), run = 0;
+    for (std::size_t y = 0; y < height; ++y) {
+        auto out = direct ? reinterpret_cast<std::uint8_t*>(image->Buffer() + y * stride) : row.data();
+        for (std::size_t x = 0; x < width; ++x) {
+            if (run) {
+                --run;
+            } else if (pos < end) {
+                auto b1 = data[pos++];
+                if (b1 == OpRGB) {
+                    std::memcpy(px, &data[pos], 3);
+                    pos += 3;
+                } else if (b1 == OpRGBA) {
+                    std::memcpy(px, &data[pos], 4);
+                    pos += 4;
+                } else {
+                    switch (b1 & OpMask) {
+                    case OpIndex:
+                        std::memcpy(px, index[b1], 4);
+                        break;
+                    case OpDiff:
+                        px[0] += (b1 >> 4 & 3) - 2;
+                        px[1] += (b1 >> 2 & 3) - 2;
+                        px[2] += (b1      & 3) - 2;
+                        break;
+                    case OpLuma:
+                        {
+                            auto b2 = data[pos++];
+                            auto vg = (b1 & 0x3f) - 32;
+                            px[0] += vg - 8 + (b2 >> 4 & 0x0f);
+                            px[1] += vg;
+                            px[2] += vg - 8 + (b2      & 0x0f);
+                        }
+                        break;
+                    default:
+                        run = b1 & 0x3f;
+                        break;
+                    }
+                }
+                std::memcpy(index[Hash(px)], px, 4);
+            }
+            std::memcpy(out + x * 4, px, 4);
+        }
+        if (!direct) {
+            auto dst = image->Buffer() + y * stride;
+            if (burnAlpha) Detail::ConvertPixelFormat<true >(dst, format, row.data(), RGBA8888, width);
+            else           Detail::ConvertPixelFormat<false>(dst, format, row.data(), RGBA8888, width);
+        }
+    }
+    stream->Consume(size);
+    return image;
+}
+
+void SaveImageQOI(Stream::SharedStream stream, const SharedImage image) {
+    auto source = image->Format();
+    if (image->Rank() > 2 || !Detail::GetBytesPerPixel(source)) {
+        throw std::invalid_argument("SaveImageQOI: Unsupported image.");
+    }
+    auto width    = image->Length(0);
+    auto height   = image->Length(1);
+    auto channels = source == RGBA5650 || source == BGRA5650 ? 3 : 4;
+    std::vector<std::uint8_t> data;
+    data.reserve(HeaderSize + width * height * 5 + sizeof(Padding));
+    data.insert(data.end(), Magic, Magic + sizeof(Magic));
+    PutBE32(data, width);
+    PutBE32(data, height);
+    data.push_back(channels);
+    data.push_back(0); // sRGB with linear alpha
+    std::vector<std::uint8_t> row(width * 4);
+    std::uint8_t index[64][4] = {};
+    std::uint8_t prev[4]      = {0, 0, 0, 255};
+    std::size_t  run          = 0;
+    auto src = static_cast<const std::byte*>(image->Data());
+    for (std::size_t y = 0; y < height; ++y) {
+        Detail::ConvertPixelFormat<false>(row.data(), RGBA8888, src + y * image->Stride(), source, width);
+        for (std::size_t x = 0; x < width; ++x) {
+            auto px = row.data() + x * 4;
+            if (std::memcmp(px, prev, 4) == 0) {
+                if (++run == 62 || (y == height - 1 && x == width - 1)) {
+                    data.push_back(OpRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run) {
+                data.push_back(OpRun | (run - 1));
+                run = 0;
+            }
+            auto hash = Hash(px);
+            if (std::memcmp(index[hash], px, 4) == 0) {
+                data.push_back(OpIndex | hash);
+            } else {
+                std::memcpy(index[hash], px, 4);
+                if (px[3] == prev[3]) {
+                    auto vr  = static_cast<std::int8_t>(px[0] - prev[0]);
+                    auto vg  = static_cast<std::int8_t>(px[1] - prev[1]);
+                    auto vb  = static_cast<std::int8_t>(px[2] - prev[2]);
+                    auto vgr = vr - vg;
+                    auto vgb = vb - vg;
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                        data.push_back(OpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                    } else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                        data.push_back(OpLuma | (vg + 32));
+                        data.push_back((vgr + 8) << 4 | (vgb + 8));
+                    } else {
+                        data.push_back(OpRGB);
+                        data.insert(data.end(), px, px + 3);
+                    }
+                } else {
+                    data.push_back(OpRGBA);
+                    data.insert(data.end(), px, px + 4);
+                }
+            }
+            std::memcpy(prev, px, 4);
+        }
+    }
+    data.insert(data.end(), Padding, Padding + sizeof(Padding));
+    if (stream->Write(data.data(), data.size()) < data.size()) {
+        throw std::runtime_error("SaveImageQOI: Failed to write stream.");
+    }
+}
+
+} // namespace Graphene::Graphics
@@ -0,0 +1,90 @@
+/** @file
+ * @brief 部分画像データ
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/view.hpp>
+#include <stdexcept>
+#include "../detail/pixconv.hpp"
+
+namespace Graphene::Graphics {
+
+namespace {
+
+class ImageView final : public Image {
+public:
+    ImageView(const SharedImage image, std::size_t x, std::size_t y, std::size_t width, std::size_t height) :
+    Image_ (image),
+    Length_{width, height} {
+        auto format = image->Format();
+        auto block  = Detail::GetBytesPerBlock(format);
+        if (!block && !Detail::GetBytesPerPixel(format)) {
+            throw std::invalid_argument("CreateImageView: Unsupported image.");
+        }
+        if (block && (x % 4 || y % 4)) {
+            throw std::invalid_argument("CreateImageView: Unaligned block position.");
+        }
+        if (x > image->Length(0) || width > image->Length(0) - x || y > image->Length(1) || height > image->Length(1) - y) {
+            throw std::out_of_range("CreateImageView: Out of range.");
+        }
+        Offset_ = Detail::GetRowCount(format, y) * image->Stride() + Detail::GetBytesPerRow(format, x);
+        Size_   = Detail::GetRowCount(format, height) ? (Detail::GetRowCount(format, height) - 1) * image->Stride() + Detail::GetBytesPerRow(format, width) : 0;
+    }
+
+    virtual const void* Data(void) const override {
+        return static_cast<const std::byte*>(Image_->Data()) + Offset_;
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Size_;
+    }
+
+    // 矩形は先頭の面のみを表すため、元画像の次元数に関わらず2次元の画像になる
+    virtual std::size_t Rank(void) const override {
+        return 2;
+    }
+
+    virtual std::size_t Length(std::size_t axis) const override {
+        return axis < 2 ? Length_[axis] : 1;
+    }
+
+    virtual std::size_t Stride(void) const override {
+        return Image_->Stride();
+    }
+
+    virtual PixelFormat Format(void) const override {
+        return Image_->Format();
+    }
+
+private:
+    SharedImage Image_;
+    std::size_t Length_[2];
+    std::size_t Offset_;
+    std::size_t Size_;
+};
+
+} // namespace
+
+SharedImage CreateImageView(const SharedImage image, std::size_t x, std::size_t y, std::size_t width, std::size_t height) {
+    return std::make_shared<ImageView>(image, x, y, width, height);
+}
+
+std::vector<SharedImage> SliceImage(const SharedImage image, std::size_t width, std::size_t height) {
+    if (!width || !height) {
+        throw std::invalid_argument("SliceImage: Empty cell.");
+    }
+    std::vector<SharedImage> cells;
+    auto cols = image->Length(0) / width;
+    auto rows = image->Length(1) / height;
+    cells.reserve(cols * rows);
+    for (std::size_t y = 0; y < rows; ++y) {
+        for (std::size_t x = 0; x < cols; ++x) {
+            cells.push_back(std::make_shared<ImageView>(image, x * width, y * height, width, height));
+        }
+    }
+    return cells;
+}
+
+} // namespace Graphene::Graphics
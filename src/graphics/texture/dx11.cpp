@@ -6,9 +6,28 @@
  * or copy at https://opensource.org/licenses/MIT)
  */
 #include "dx11.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace Graphene::Graphics {
 
+namespace {
+
+bool IsBlockCompressed(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
 TextureDX11::TextureDX11(
     Microsoft::WRL::ComPtr<ID3D11Device> device,
     const SharedImage                    image,
@@ -23,18 +42,26 @@ TextureDX11::TextureDX11(
     case BGRA4444: format = DXGI_FORMAT_B4G4R4A4_UNORM;     break;
     case BGRA5551: format = DXGI_FORMAT_B5G5R5A1_UNORM;     break;
     case BGRA5650: format = DXGI_FORMAT_B5G6R5_UNORM;       break;
+    case BC1UNORM: format = DXGI_FORMAT_BC1_UNORM;          break;
+    case BC3UNORM: format = DXGI_FORMAT_BC3_UNORM;          break;
+    case BC4UNORM: format = DXGI_FORMAT_BC4_UNORM;          break;
+    case BC5UNORM: format = DXGI_FORMAT_BC5_UNORM;          break;
+    case BC7UNORM: format = DXGI_FORMAT_BC7_UNORM;          break;
     default: throw std::runtime_error("GenerateTexture: Unsupported format.");
     }
-    D3D11_SUBRESOURCE_DATA subres;
-    subres.pSysMem          = image->Data();
-    subres.SysMemPitch      = image->Stride();
-    subres.SysMemSlicePitch = image->Stride() * image->Length(1);
+    std::vector<D3D11_SUBRESOURCE_DATA> subres(image->Levels());
+    for (std::size_t i = 0; i < subres.size(); ++i) {
+        auto height = std::max<std::size_t>(image->Length(1) >> i, 1);
+        subres[i].pSysMem          = static_cast<const std::byte*>(image->Data()) + image->LevelOffset(i);
+        subres[i].SysMemPitch      = image->LevelStride(i);
+        subres[i].SysMemSlicePitch = image->LevelStride(i) * (IsBlockCompressed(format) ? (height + 3) / 4 : height);
+    }
     switch (image->Rank()) {
     case 1:
         {
             D3D11_TEXTURE1D_DESC desc;
             desc.Width              = image->Length(0);
-            desc.MipLevels          = 1;
+            desc.MipLevels          = subres.size();
             desc.ArraySize          = 1;
             desc.Format             = format;
             desc.Usage              = D3D11_USAGE_IMMUTABLE;
@@ -42,7 +69,7 @@ TextureDX11::TextureDX11(
             desc.CPUAccessFlags     = 0;
             desc.MiscFlags          = 0;
             Microsoft::WRL::ComPtr<ID3D11Texture1D> texture;
-            auto hr = device->CreateTexture1D(&desc, &subres, texture.GetAddressOf());
+            auto hr = device->CreateTexture1D(&desc, subres.data(), texture.GetAddressOf());
             if (FAILED(hr)) throw std::system_error(hr, std::system_category());
             Texture_ = texture;
         }
@@ -51,7 +78,7 @@ TextureDX11::TextureDX11(
             desc.Format                    = format;
             desc.ViewDimension             = D3D11_SRV_DIMENSION_TEXTURE1D;
             desc.Texture1D.MostDetailedMip = 0;
-            desc.Texture1D.MipLevels       = 1;
+            desc.Texture1D.MipLevels       = subres.size();
             auto hr = device->CreateShaderResourceView(Texture_.Get(), &desc, TextureView_.GetAddressOf());
             if (FAILED(hr)) throw std::system_error(hr, std::system_category());
         }
@@ -61,7 +88,7 @@ TextureDX11::TextureDX11(
             D3D11_TEXTURE2D_DESC desc;
             desc.Width              = image->Length(0);
             desc.Height             = image->Length(1);
-            desc.MipLevels          = 1;
+            desc.MipLevels          = subres.size();
             desc.ArraySize          = 1;
             desc.Format             = format;
             desc.SampleDesc.Count   = 1;
@@ -71,7 +98,7 @@ TextureDX11::TextureDX11(
             desc.CPUAccessFlags     = 0;
             desc.MiscFlags          = 0;
             Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
-            auto hr = device->CreateTexture2D(&desc, &subres, texture.GetAddressOf());
+            auto hr = device->CreateTexture2D(&desc, subres.data(), texture.GetAddressOf());
             if (FAILED(hr)) throw std::system_error(hr, std::system_category());
             Texture_ = texture;
         }
@@ -80,7 +107,7 @@ TextureDX11::TextureDX11(
             desc.Format                    = format;
             desc.ViewDimension             = D3D11_SRV_DIMENSION_TEXTURE2D;
             desc.Texture2D.MostDetailedMip = 0;
-            desc.Texture2D.MipLevels       = 1;
+            desc.Texture2D.MipLevels       = subres.size();
             auto hr = device->CreateShaderResourceView(Texture_.Get(), &desc, TextureView_.GetAddressOf());
             if (FAILED(hr)) throw std::system_error(hr, std::system_category());
         }
@@ -91,14 +118,14 @@ TextureDX11::TextureDX11(
             desc.Width              = image->Length(0);
             desc.Height             = image->Length(1);
             desc.Depth              = image->Length(2);
-            desc.MipLevels          = 1;
+            desc.MipLevels          = subres.size();
             desc.Format             = format;
             desc.Usage              = D3D11_USAGE_IMMUTABLE;
             desc.BindFlags          = D3D11_BIND_SHADER_RESOURCE;
             desc.CPUAccessFlags     = 0;
             desc.MiscFlags          = 0;
             Microsoft::WRL::ComPtr<ID3D11Texture3D> texture;
-            auto hr = device->CreateTexture3D(&desc, &subres, texture.GetAddressOf());
+            auto hr = device->CreateTexture3D(&desc, subres.data(), texture.GetAddressOf());
             if (FAILED(hr)) throw std::system_error(hr, std::system_category());
             Texture_ = texture;
         }
@@ -107,7 +134,7 @@ TextureDX11::TextureDX11(
             desc.Format                    = format;
             desc.ViewDimension             = D3D11_SRV_DIMENSION_TEXTURE3D;
             desc.Texture3D.MostDetailedMip = 0;
-            desc.Texture3D.MipLevels       = 1;
+            desc.Texture3D.MipLevels       = subres.size();
             auto hr = device->CreateShaderResourceView(Texture_.Get(), &desc, TextureView_.GetAddressOf());
             if (FAILED(hr)) throw std::system_error(hr, std::system_category());
         }
@@ -21,6 +21,11 @@ extern "C" {
 
 #ifdef __cplusplus
 }
+
+#include <cstddef>
+#include <span>
+
+#define RESOURCE_SPAN(x) (std::span<const std::byte>(reinterpret_cast<const std::byte*>(RESOURCE_DATA(x)), RESOURCE_SIZE(x)))
 #endif
 
 #endif // GRAPHENE_RESOURCE_H
@@ -0,0 +1,340 @@
+/** @file
+ * @brief アーカイブ入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/archive.hpp>
+#include <graphene/stream/compress.hpp>
+#include <graphene/stream/copy.hpp>
+#include <graphene/stream/mapped.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include "detail/mode.hpp"
+
+namespace Graphene::Stream {
+
+namespace {
+
+// ファイル構造(リトルエンディアン)
+//   0: マジックナンバー "GPK\x1a"
+//   4: バージョン                     (4 bytes)
+//   8: エントリ数                     (4 bytes)
+//  12: 予約                           (4 bytes)
+//  16: 目次の位置                     (8 bytes)
+//  24: 目次のサイズ                   (8 bytes)
+//  32: 64バイト境界に配置した各エントリのデータ
+//  目次: (位置 8 bytes,サイズ 8 bytes,フラグ 4 bytes,名前の長さ 4 bytes,名前) x エントリ数(名前順)
+//  フラグ: bit0 = GLZ形式で圧縮
+constexpr char          Magic[4]   = {'G', 'P', 'K', '\x1a'};
+constexpr std::uint32_t Version    = 1;
+constexpr std::size_t   HeaderSize = 32;
+constexpr std::size_t   RecordSize = 24;
+constexpr std::size_t   DataAlign  = 64;
+constexpr std::size_t   CopyChunk  = 1024 * 1024;
+constexpr std::uint32_t FlagCompressed = 1 << 0;
+
+std::uint64_t Get(const std::byte* data, std::size_t n) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < n; ++i) value |= static_cast<std::uint64_t>(data[i]) << (i * 8);
+    return value;
+}
+
+void Put(std::byte* data, std::uint64_t value, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) data[i] = static_cast<std::byte>(value >> (i * 8));
+}
+
+// マップされたアーカイブのエントリ
+class MappedEntry final : public Stream, public MappedStream {
+public:
+    MappedEntry(SharedStream stream, const std::byte* data, std::size_t offset, std::size_t size) :
+    Stream_  (stream),
+    Data_    (data + offset),
+    Offset_  (offset),
+    Size_    (size),
+    Position_(0),
+    Open_    (true) {
+    }
+
+    virtual void Close(void) override {
+        Open_ = false;
+    }
+
+    virtual bool Flush(void) override {
+        return Open_;
+    }
+
+    virtual std::size_t Read(void* data, std::size_t size) override {
+        if (!Open_ || !data) return 0;
+        size = std::min(size, Size_ - std::min(Position_, Size_));
+        if (size) std::memcpy(data, Data_ + Position_, size);
+        Position_ += size;
+        return size;
+    }
+
+    virtual std::span<const std::byte> Peek(std::size_t size) override {
+        if (!Open_) return {};
+        auto offset = std::min(Position_, Size_);
+        return {Data_ + offset, std::min(size, Size_ - offset)};
+    }
+
+    virtual std::size_t Consume(std::size_t size) override {
+        if (!Open_) return 0;
+        size = std::min(size, Size_ - std::min(Position_, Size_));
+        Position_ += size;
+        return size;
+    }
+
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override {
+        if (!Open_ || !data) return 0;
+        size = std::min(size, Size_ - std::min(offset, Size_));
+        if (size) std::memcpy(data, Data_ + offset, size);
+        return size;
+    }
+
+    virtual std::size_t Write(const void* data, std::size_t size) override {
+        return 0;
+    }
+
+    virtual bool Seek(std::size_t offset) override {
+        if (!Open_) return false;
+        Position_ = offset;
+        return true;
+    }
+
+    virtual std::size_t Tell(void) const override {
+        return Open_ ? Position_ : 0;
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Open_ ? Size_ : 0;
+    }
+
+    virtual bool Advise(AccessHint hint, std::size_t offset, std::size_t size) override {
+        if (!Open_ || offset >= Size_) return false;
+        return Stream_->Advise(hint, Offset_ + offset, size ? std::min(size, Size_ - offset) : Size_ - offset);
+    }
+
+    virtual std::span<const std::byte> Mapping(void) const override {
+        return {Data_, Size_};
+    }
+
+private:
+    SharedStream     Stream_;
+    const std::byte* Data_;
+    std::size_t      Offset_;
+    std::size_t      Size_;
+    std::size_t      Position_;
+    bool             Open_;
+};
+
+// 元のストリームの範囲を切り出したエントリ
+class BoundedEntry final : public Stream {
+public:
+    BoundedEntry(SharedStream stream, std::size_t offset, std::size_t size) :
+    Stream_  (stream),
+    Offset_  (offset),
+    Size_    (size),
+    Position_(0) {
+    }
+
+    virtual void Close(void) override {
+        Stream_.reset();
+    }
+
+    virtual bool Flush(void) override {
+        return Stream_ != nullptr;
+    }
+
+    virtual std::size_t Read(void* data, std::size_t size) override {
+        auto n = ReadAt(Position_, data, size);
+        Position_ += n;
+        return n;
+    }
+
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override {
+        if (!Stream_ || !data) return 0;
+        size = std::min(size, Size_ - std::min(offset, Size_));
+        return size ? Stream_->ReadAt(Offset_ + offset, data, size) : 0;
+    }
+
+    virtual std::size_t Write(const void* data, std::size_t size) override {
+        return 0;
+    }
+
+    virtual bool Seek(std::size_t offset) override {
+        if (!Stream_) return false;
+        Position_ = offset;
+        return true;
+    }
+
+    virtual std::size_t Tell(void) const override {
+        return Stream_ ? Position_ : 0;
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Stream_ ? Size_ : 0;
+    }
+
+    virtual bool Advise(AccessHint hint, std::size_t offset, std::size_t size) override {
+        if (!Stream_ || offset >= Size_) return false;
+        return Stream_->Advise(hint, Offset_ + offset, size ? std::min(size, Size_ - offset) : Size_ - offset);
+    }
+
+private:
+    SharedStream Stream_;
+    std::size_t  Offset_;
+    std::size_t  Size_;
+    std::size_t  Position_;
+};
+
+} // namespace
+
+ArchiveFactory::ArchiveFactory(const std::string& path) :
+ArchiveFactory(MappedFileFactory().Open(path, "r")) {
+}
+
+ArchiveFactory::ArchiveFactory(SharedStream stream) :
+Stream_(stream),
+Data_  (nullptr),
+Size_  (stream->Size()) {
+    if (auto mapped = dynamic_cast<MappedStream*>(stream.get())) {
+        Owner_ = stream;
+        Data_  = mapped->Mapping().data();
+        Size_  = mapped->Mapping().size();
+    }
+    Parse();
+}
+
+SharedStream ArchiveFactory::Open(const std::string& path, const std::string& mode) {
+    if (!Detail::IsReadMode(mode)) {
+        throw std::invalid_argument("ArchiveFactory: Unsupported mode.");
+    }
+    auto it = std::lower_bound(Entries_.begin(), Entries_.end(), path, [](const Entry& e, const std::string& name) { return e.Name < name; });
+    if (it == Entries_.end() || it->Name != path) {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path);
+    }
+    SharedStream stream;
+    if (Owner_) stream = std::make_shared<MappedEntry>(Stream_, Data_, it->Offset, it->Size);
+    else        stream = std::make_shared<BoundedEntry>(Stream_, it->Offset, it->Size);
+    if (it->Flags & FlagCompressed) return std::make_shared<CompressedStream>(stream, "r");
+    return stream;
+}
+
+std::vector<std::string> ArchiveFactory::Names(void) const {
+    std::vector<std::string> names;
+    names.reserve(Entries_.size());
+    for (auto& entry : Entries_) names.push_back(entry.Name);
+    return names;
+}
+
+void ArchiveFactory::Parse(void) {
+    auto read = [this](std::size_t offset, std::size_t size) {
+        if (offset > Size_ || size > Size_ - offset) {
+            throw std::runtime_error("ArchiveFactory: Broken archive.");
+        }
+        std::vector<std::byte> buffer(size);
+        if (Owner_) {
+            if (size) std::memcpy(buffer.data(), Data_ + offset, size);
+        } else if (!Stream_->Seek(offset) || Stream_->Read(buffer.data(), size) < size) {
+            throw std::runtime_error("ArchiveFactory: Failed to read stream.");
+        }
+        return buffer;
+    };
+    auto header = read(0, HeaderSize);
+    if (std::memcmp(header.data(), Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("ArchiveFactory: Invalid signature.");
+    }
+    if (Get(header.data() + 4, 4) != Version) {
+        throw std::runtime_error("ArchiveFactory: Unsupported version.");
+    }
+    auto count = Get(header.data() + 8, 4);
+    auto toc   = read(Get(header.data() + 16, 8), Get(header.data() + 24, 8));
+    Entries_.reserve(std::min<std::size_t>(count, toc.size() / RecordSize));
+    for (std::size_t i = 0, pos = 0; i < count; ++i) {
+        if (toc.size() - pos < RecordSize) {
+            throw std::runtime_error("ArchiveFactory: Broken table of contents.");
+        }
+        Entry entry;
+        entry.Offset = Get(toc.data() + pos,      8);
+        entry.Size   = Get(toc.data() + pos +  8, 8);
+        entry.Flags  = Get(toc.data() + pos + 16, 4);
+        auto length  = Get(toc.data() + pos + 20, 4);
+        pos += RecordSize;
+        if (toc.size() - pos < length || entry.Offset > Size_ || entry.Size > Size_ - entry.Offset) {
+            throw std::runtime_error("ArchiveFactory: Broken table of contents.");
+        }
+        entry.Name.assign(reinterpret_cast<const char*>(toc.data() + pos), length);
+        pos += length;
+        Entries_.push_back(std::move(entry));
+    }
+    auto less = [](const Entry& a, const Entry& b) { return a.Name < b.Name; };
+    if (!std::is_sorted(Entries_.begin(), Entries_.end(), less)) {
+        std::sort(Entries_.begin(), Entries_.end(), less);
+    }
+}
+
+void SaveArchive(SharedStream stream, SharedStreamFactory factory, std::vector<ArchiveEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) { return a.Name < b.Name; });
+    for (std::size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i - 1].Name == entries[i].Name) {
+            throw std::invalid_argument("SaveArchive: Duplicate entry name.");
+        }
+    }
+    auto write = [&stream](const void* data, std::size_t size) {
+        if (stream->Write(data, size) < size) {
+            throw std::runtime_error("SaveArchive: Failed to write stream.");
+        }
+    };
+    const std::byte padding[DataAlign] = {};
+    auto base     = stream->Tell();
+    auto position = HeaderSize;
+    std::vector<std::byte> header(HeaderSize);
+    std::vector<std::byte> toc;
+    std::vector<std::byte> chunk(CopyChunk);
+    write(header.data(), header.size());
+    for (auto& entry : entries) {
+        auto aligned = (position + DataAlign - 1) / DataAlign * DataAlign;
+        write(padding, aligned - position);
+        position = aligned;
+        auto source = factory->Open(entry.Path, "r");
+        if (entry.Compress) {
+            auto compressed = std::make_shared<CompressedStream>(stream, "w");
+            while (auto n = source->Read(chunk.data(), chunk.size())) {
+                if (compressed->Write(chunk.data(), n) < n) {
+                    throw std::runtime_error("SaveArchive: Failed to write stream.");
+                }
+            }
+            compressed->Close();
+        } else {
+            CopyStream(stream, source);
+        }
+        auto size = stream->Tell() - base - position;
+        std::byte record[RecordSize];
+        Put(record,      position, 8);
+        Put(record +  8, size,     8);
+        Put(record + 16, entry.Compress ? FlagCompressed : 0, 4);
+        Put(record + 20, entry.Name.size(), 4);
+        toc.insert(toc.end(), record, record + RecordSize);
+        toc.insert(toc.end(), reinterpret_cast<const std::byte*>(entry.Name.data()), reinterpret_cast<const std::byte*>(entry.Name.data()) + entry.Name.size());
+        position += size;
+    }
+    write(toc.data(), toc.size());
+    std::memcpy(header.data(), Magic, sizeof(Magic));
+    Put(header.data() +  4, Version,        4);
+    Put(header.data() +  8, entries.size(), 4);
+    Put(header.data() + 16, position,       8);
+    Put(header.data() + 24, toc.size(),     8);
+    if (!stream->Seek(base)) {
+        throw std::runtime_error("SaveArchive: Failed to seek stream.");
+    }
+    write(header.data(), header.size());
+    if (!stream->Seek(base + position + toc.size())) {
+        throw std::runtime_error("SaveArchive: Failed to seek stream.");
+    }
+}
+
+} // namespace Graphene::Stream
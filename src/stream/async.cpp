@@ -0,0 +1,230 @@
+/** @file
+ * @brief 非同期入力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/async.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "../config.hpp"
+#include "detail/workers.hpp"
+
+#if USE_IO_URING
+#include <cerrno>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace Graphene::Stream {
+
+namespace {
+
+constexpr std::size_t MaxThreads = 64;
+
+class ThreadPoolReader final : public AsyncReader {
+public:
+    explicit ThreadPoolReader(std::size_t depth) :
+    Workers_(std::min(depth, MaxThreads)) {
+    }
+
+    virtual std::future<std::size_t> Submit(SharedStream stream, std::size_t offset, void* data, std::size_t size) override {
+        return Workers_.Submit([stream, offset, data, size] {
+            return stream->ReadAt(offset, data, size);
+        });
+    }
+
+private:
+    Detail::WorkerPool Workers_;
+};
+
+#if USE_IO_URING
+class UringReader final : public AsyncReader {
+public:
+    explicit UringReader(std::size_t depth) :
+    Depth_   (0),
+    InFlight_(0) {
+        io_uring_params params = {};
+        Ring_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(std::min<std::size_t>(depth, 4096)), &params));
+        if (Ring_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+        }
+        SQSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        CQSize_ = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) SQSize_ = CQSize_ = std::max(SQSize_, CQSize_);
+        SQ_   = Map(SQSize_, IORING_OFF_SQ_RING);
+        CQ_   = params.features & IORING_FEAT_SINGLE_MMAP ? SQ_ : Map(CQSize_, IORING_OFF_CQ_RING);
+        SQEs_ = static_cast<io_uring_sqe*>(Map(params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+        SQEntries_ = params.sq_entries;
+        if (!SQ_ || !CQ_ || !SQEs_) {
+            auto error = errno;
+            Unmap();
+            throw std::system_error(error, std::generic_category(), "io_uring mmap");
+        }
+        auto sq = static_cast<char*>(SQ_);
+        auto cq = static_cast<char*>(CQ_);
+        SQTail_  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        SQMask_  = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        SQArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        CQHead_  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        CQTail_  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        CQMask_  = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        CQEs_    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        Depth_   = std::min<std::size_t>(depth, params.sq_entries);
+        Reaper_  = std::thread([this] { Reap(); });
+    }
+
+    virtual ~UringReader() override {
+        {
+            std::unique_lock<std::mutex> lock(Mutex_);
+            Condition_.wait(lock, [this] { return InFlight_ == 0; });
+            Push(nullptr, IORING_OP_NOP, -1, 0); // 完了スレッドへの終了通知
+        }
+        Reaper_.join();
+        Fallback_.reset();
+        Unmap();
+    }
+
+    virtual std::future<std::size_t> Submit(SharedStream stream, std::size_t offset, void* data, std::size_t size) override {
+        auto descriptor = dynamic_cast<DescriptorStream*>(stream.get());
+        if (!descriptor) {
+            std::call_once(FallbackOnce_, [this] { Fallback_ = std::make_unique<ThreadPoolReader>(Depth_); });
+            return Fallback_->Submit(stream, offset, data, size);
+        }
+        auto request = new Request{stream, {data, size}, {}};
+        auto future  = request->Promise.get_future();
+        std::unique_lock<std::mutex> lock(Mutex_);
+        Condition_.wait(lock, [this] { return InFlight_ < Depth_; });
+        ++InFlight_;
+        request->Vector.iov_len = size;
+        if (auto error = Push(request, IORING_OP_READV, descriptor->Descriptor(), offset)) {
+            --InFlight_;
+            request->Promise.set_exception(std::make_exception_ptr(std::system_error(error, std::generic_category(), "AsyncReader")));
+            delete request;
+        }
+        return future;
+    }
+
+private:
+    struct Request {
+        SharedStream              Stream;
+        iovec                     Vector;
+        std::promise<std::size_t> Promise;
+    };
+
+    void* Map(std::size_t size, std::uint64_t offset) {
+        auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Ring_, offset);
+        return data == MAP_FAILED ? nullptr : data;
+    }
+
+    void Unmap(void) {
+        if (SQEs_) munmap(SQEs_, SQEntries_ * sizeof(io_uring_sqe));
+        if (CQ_ && CQ_ != SQ_) munmap(CQ_, CQSize_);
+        if (SQ_) munmap(SQ_, SQSize_);
+        close(Ring_);
+    }
+
+    // Mutex_をロックした状態で呼び出す
+    // 投入に失敗した場合は末尾を戻してエラー番号を返す
+    int Push(Request* request, int opcode, int fd, std::size_t offset) {
+        auto tail  = std::atomic_ref<unsigned>(*SQTail_).load(std::memory_order_relaxed);
+        auto index = tail & SQMask_;
+        auto& sqe  = SQEs_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = static_cast<std::uint8_t>(opcode);
+        sqe.fd        = fd;
+        sqe.off       = offset;
+        sqe.addr      = request ? reinterpret_cast<std::uint64_t>(&request->Vector) : 0;
+        sqe.len       = request ? 1 : 0;
+        sqe.user_data = reinterpret_cast<std::uint64_t>(request);
+        SQArray_[index] = index;
+        std::atomic_ref<unsigned>(*SQTail_).store(tail + 1, std::memory_order_release);
+        while (syscall(__NR_io_uring_enter, Ring_, 1, 0, 0, nullptr, 0) < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            auto error = errno;
+            std::atomic_ref<unsigned>(*SQTail_).store(tail, std::memory_order_release);
+            return error;
+        }
+        return 0;
+    }
+
+    // 完了キューを監視して結果を通知する
+    void Reap(void) {
+        for (;;) {
+            auto head = std::atomic_ref<unsigned>(*CQHead_).load(std::memory_order_relaxed);
+            if (head == std::atomic_ref<unsigned>(*CQTail_).load(std::memory_order_acquire)) {
+                syscall(__NR_io_uring_enter, Ring_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+            auto& cqe     = CQEs_[head & CQMask_];
+            auto  request = reinterpret_cast<Request*>(cqe.user_data);
+            auto  result  = cqe.res;
+            std::atomic_ref<unsigned>(*CQHead_).store(head + 1, std::memory_order_release);
+            if (!request) return;
+            if (result < 0) {
+                request->Promise.set_exception(std::make_exception_ptr(std::system_error(-result, std::generic_category(), "AsyncReader")));
+            } else {
+                request->Promise.set_value(result);
+            }
+            delete request;
+            {
+                std::lock_guard<std::mutex> lock(Mutex_);
+                --InFlight_;
+            }
+            Condition_.notify_all();
+        }
+    }
+
+private:
+    int                               Ring_;
+    void*                             SQ_   = nullptr;
+    void*                             CQ_   = nullptr;
+    io_uring_sqe*                     SQEs_ = nullptr;
+    std::size_t                       SQSize_;
+    std::size_t                       CQSize_;
+    std::size_t                       SQEntries_ = 0;
+    unsigned*                         SQTail_;
+    unsigned                          SQMask_;
+    unsigned*                         SQArray_;
+    unsigned*                         CQHead_;
+    unsigned*                         CQTail_;
+    unsigned                          CQMask_;
+    io_uring_cqe*                     CQEs_;
+    std::size_t                       Depth_;
+    std::size_t                       InFlight_;
+    std::mutex                        Mutex_;
+    std::condition_variable           Condition_;
+    std::thread                       Reaper_;
+    std::once_flag                    FallbackOnce_;
+    std::unique_ptr<ThreadPoolReader> Fallback_;
+};
+#endif
+
+} // namespace
+
+SharedAsyncReader CreateAsyncReader(std::size_t depth) {
+    if (!depth) {
+        throw std::invalid_argument("CreateAsyncReader: Zero depth.");
+    }
+#if USE_IO_URING
+    try {
+        return std::make_shared<UringReader>(depth);
+    } catch (const std::system_error&) {
+        // カーネルが未対応または制限されている場合はスレッドプールを使用する
+    }
+#endif
+    return std::make_shared<ThreadPoolReader>(depth);
+}
+
+} // namespace Graphene::Stream
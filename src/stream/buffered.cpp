@@ -0,0 +1,149 @@
+/** @file
+ * @brief バッファ付き入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/buffered.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Graphene::Stream {
+
+// 元のストリームのポインタ位置は以下を保つ
+//   書き込み待ち: Base_
+//   読み込み済み: Base_ + Fill_
+//   バッファ空  : Position_ (= Base_)
+BufferedStream::BufferedStream(SharedStream stream, std::size_t size) :
+Stream_  (stream),
+Buffer_  (size),
+Base_    (stream->Tell()),
+Fill_    (0),
+Position_(Base_),
+Dirty_   (false) {
+    if (!size) {
+        throw std::invalid_argument("BufferedStream: Empty buffer.");
+    }
+}
+
+BufferedStream::~BufferedStream() {
+    FlushBuffer();
+}
+
+void BufferedStream::Close(void) {
+    FlushBuffer();
+    Stream_->Close();
+    Base_ = Position_ = Fill_ = 0;
+}
+
+bool BufferedStream::Flush(void) {
+    return FlushBuffer() && Stream_->Flush();
+}
+
+std::size_t BufferedStream::Read(void* data, std::size_t size) {
+    if (!data || !FlushBuffer()) return 0;
+    auto out   = static_cast<std::byte*>(data);
+    auto total = std::size_t(0);
+    while (total < size) {
+        auto avail = std::min(Base_ + Fill_ - Position_, size - total);
+        std::memcpy(out + total, Buffer_.data() + (Position_ - Base_), avail);
+        Position_ += avail;
+        total     += avail;
+        if (total == size) break;
+        if (size - total >= Buffer_.size()) {
+            auto n = Stream_->Read(out + total, size - total);
+            Position_ += n;
+            total     += n;
+            Base_      = Position_;
+            Fill_      = 0;
+            break;
+        }
+        Base_ = Position_;
+        Fill_ = Stream_->Read(Buffer_.data(), Buffer_.size());
+        if (!Fill_) break;
+    }
+    return total;
+}
+
+std::span<const std::byte> BufferedStream::Peek(std::size_t size) {
+    if (size > Buffer_.size()) return Stream::Peek(size);
+    if (!FlushBuffer()) return {};
+    if (Base_ + Fill_ - Position_ < size) {
+        // 未読のデータを先頭に詰めて続きを読み込む
+        auto rest = Base_ + Fill_ - Position_;
+        std::memmove(Buffer_.data(), Buffer_.data() + (Position_ - Base_), rest);
+        Base_ = Position_;
+        Fill_ = rest + Stream_->Read(Buffer_.data() + rest, Buffer_.size() - rest);
+    }
+    return {Buffer_.data() + (Position_ - Base_), std::min(size, Base_ + Fill_ - Position_)};
+}
+
+std::size_t BufferedStream::ReadAt(std::size_t offset, void* data, std::size_t size) {
+    if (!data) return 0;
+    auto n = Stream_->ReadAt(offset, data, size);
+    // 書き込み待ちのデータは元のストリームより新しい
+    if (!Dirty_ || offset >= Base_ + Fill_ || offset + size <= Base_ || offset + n < Base_) return n;
+    auto begin = std::max(offset, Base_);
+    auto end   = std::min(offset + size, Base_ + Fill_);
+    std::memcpy(static_cast<std::byte*>(data) + (begin - offset), Buffer_.data() + (begin - Base_), end - begin);
+    return std::max(n, end - offset);
+}
+
+std::size_t BufferedStream::Write(const void* data, std::size_t size) {
+    if (!data) return 0;
+    if (!Dirty_ && Fill_) {
+        if (Position_ != Base_ + Fill_ && !Stream_->Seek(Position_)) return 0;
+        Base_ = Position_;
+        Fill_ = 0;
+    }
+    if (Fill_ + size > Buffer_.size() && !FlushBuffer()) return 0;
+    if (size >= Buffer_.size()) {
+        auto n = Stream_->Write(data, size);
+        Position_ += n;
+        Base_      = Position_;
+        return n;
+    }
+    std::memcpy(Buffer_.data() + Fill_, data, size);
+    Dirty_     = true;
+    Fill_     += size;
+    Position_ += size;
+    return size;
+}
+
+bool BufferedStream::Seek(std::size_t offset) {
+    if (!Dirty_ && offset >= Base_ && offset <= Base_ + Fill_) {
+        Position_ = offset;
+        return true;
+    }
+    FlushBuffer();
+    auto result = Stream_->Seek(offset);
+    Base_ = Position_ = Stream_->Tell();
+    Fill_ = 0;
+    return result;
+}
+
+std::size_t BufferedStream::Tell(void) const {
+    return Position_;
+}
+
+std::size_t BufferedStream::Size(void) const {
+    return Dirty_ ? std::max(Stream_->Size(), Base_ + Fill_) : Stream_->Size();
+}
+
+bool BufferedStream::Advise(AccessHint hint, std::size_t offset, std::size_t size) {
+    return Stream_->Advise(hint, offset, size);
+}
+
+bool BufferedStream::FlushBuffer(void) {
+    if (!Dirty_) return true;
+    auto n = Stream_->Write(Buffer_.data(), Fill_);
+    auto result = n == Fill_;
+    Base_  = Position_ = Base_ + n;
+    Fill_  = 0;
+    Dirty_ = false;
+    return result;
+}
+
+} // namespace Graphene::Stream
@@ -0,0 +1,183 @@
+/** @file
+ * @brief チェックサム
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/checksum.hpp>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <nmmintrin.h>
+#define GRAPHENE_CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace Graphene::Stream {
+
+namespace {
+
+using UpdateFunction = std::uint32_t (*)(std::uint32_t, const std::uint8_t*, std::size_t);
+
+// スライス8のテーブル(反転多項式 0x82f63b78)
+constexpr auto Table = [] {
+    std::array<std::array<std::uint32_t, 256>, 8> table = {};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        auto crc = i;
+        for (int k = 0; k < 8; ++k) crc = crc & 1 ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+        table[0][i] = crc;
+    }
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        for (std::size_t k = 1; k < 8; ++k) table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+    }
+    return table;
+}();
+
+std::uint32_t UpdateTable(std::uint32_t crc, const std::uint8_t* p, std::size_t size) {
+    for (; size >= 8; p += 8, size -= 8) {
+        auto lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | static_cast<std::uint32_t>(p[3]) << 24);
+        crc = Table[7][lo & 0xff] ^ Table[6][lo >> 8 & 0xff] ^ Table[5][lo >> 16 & 0xff] ^ Table[4][lo >> 24] ^
+              Table[3][p[4]]      ^ Table[2][p[5]]          ^ Table[1][p[6]]           ^ Table[0][p[7]];
+    }
+    for (; size; ++p, --size) crc = (crc >> 8) ^ Table[0][(crc ^ *p) & 0xff];
+    return crc;
+}
+
+#if defined(GRAPHENE_CRC32C_X86)
+#if defined(__GNUC__) && !defined(__SSE4_2__)
+__attribute__((target("sse4.2")))
+#endif
+std::uint32_t UpdateSSE42(std::uint32_t crc, const std::uint8_t* p, std::size_t size) {
+    for (; size && reinterpret_cast<std::uintptr_t>(p) & 7; ++p, --size) crc = _mm_crc32_u8(crc, *p);
+#if defined(__x86_64__) || defined(_M_X64)
+    std::uint64_t crc64 = crc;
+    for (; size >= 8; p += 8, size -= 8) {
+        std::uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = static_cast<std::uint32_t>(crc64);
+#endif
+    for (; size >= 4; p += 4, size -= 4) {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+    }
+    for (; size; ++p, --size) crc = _mm_crc32_u8(crc, *p);
+    return crc;
+}
+#elif defined(__ARM_FEATURE_CRC32)
+std::uint32_t UpdateARM(std::uint32_t crc, const std::uint8_t* p, std::size_t size) {
+    for (; size >= 8; p += 8, size -= 8) {
+        std::uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+    }
+    for (; size; ++p, --size) crc = __crc32cb(crc, *p);
+    return crc;
+}
+#endif
+
+UpdateFunction SelectUpdate(void) {
+#if defined(GRAPHENE_CRC32C_X86) && defined(__SSE4_2__)
+    return UpdateSSE42;
+#elif defined(GRAPHENE_CRC32C_X86) && defined(__GNUC__)
+    return __builtin_cpu_supports("sse4.2") ? UpdateSSE42 : UpdateTable;
+#elif defined(__ARM_FEATURE_CRC32)
+    return UpdateARM;
+#else
+    return UpdateTable;
+#endif
+}
+
+} // namespace
+
+void CRC32C::Update(const void* data, std::size_t size) {
+    static const auto update = SelectUpdate();
+    State_ = update(State_, static_cast<const std::uint8_t*>(data), size);
+}
+
+ChecksumStream::ChecksumStream(SharedStream stream, ChecksumType type) :
+Stream_(stream),
+Type_  (type) {
+}
+
+void ChecksumStream::Close(void) {
+    Stream_->Close();
+}
+
+bool ChecksumStream::Flush(void) {
+    return Stream_->Flush();
+}
+
+std::size_t ChecksumStream::Read(void* data, std::size_t size) {
+    auto n = Stream_->Read(data, size);
+    Update(data, n);
+    return n;
+}
+
+std::span<const std::byte> ChecksumStream::Peek(std::size_t size) {
+    return Stream_->Peek(size);
+}
+
+std::size_t ChecksumStream::Consume(std::size_t size) {
+    // 参照できない場合のコピーが大きくならないように分割して読み進める
+    constexpr std::size_t ChunkSize = 64 * 1024;
+    std::vector<std::byte> scratch;
+    auto total = std::size_t(0);
+    while (total < size) {
+        auto view = Stream_->Peek(std::min(ChunkSize, size - total), scratch);
+        auto n    = Stream_->Consume(view.size());
+        Update(view.data(), n);
+        total += n;
+        if (!n || n < view.size()) break;
+    }
+    return total;
+}
+
+std::size_t ChecksumStream::ReadAt(std::size_t offset, void* data, std::size_t size) {
+    return Stream_->ReadAt(offset, data, size);
+}
+
+std::size_t ChecksumStream::Write(const void* data, std::size_t size) {
+    auto n = Stream_->Write(data, size);
+    Update(data, n);
+    return n;
+}
+
+bool ChecksumStream::Seek(std::size_t offset) {
+    return Stream_->Seek(offset);
+}
+
+std::size_t ChecksumStream::Tell(void) const {
+    return Stream_->Tell();
+}
+
+std::size_t ChecksumStream::Size(void) const {
+    return Stream_->Size();
+}
+
+bool ChecksumStream::Advise(AccessHint hint, std::size_t offset, std::size_t size) {
+    return Stream_->Advise(hint, offset, size);
+}
+
+std::uint64_t ChecksumStream::Checksum(void) const {
+    return Type_ == ChecksumTypeCRC32C ? CRC32C_.Digest() : XXH64_.Digest();
+}
+
+void ChecksumStream::ResetChecksum(void) {
+    CRC32C_ = CRC32C();
+    XXH64_  = XXH64();
+}
+
+void ChecksumStream::Update(const void* data, std::size_t size) {
+    if (!size) return;
+    if (Type_ == ChecksumTypeCRC32C) CRC32C_.Update(data, size);
+    else                             XXH64_.Update(data, size);
+}
+
+} // namespace Graphene::Stream
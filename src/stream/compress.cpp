@@ -0,0 +1,415 @@
+/** @file
+ * @brief 圧縮入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/compress.hpp>
+#include <graphene/stream/mapped.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace Graphene::Stream {
+
+namespace {
+
+constexpr std::size_t MinMatch     = 4;
+constexpr std::size_t LastLiterals = 5;  // 末尾の5バイトは必ずリテラル
+constexpr std::size_t MatchLimit   = 12; // 末尾12バイト以内からは一致を開始しない
+constexpr std::size_t MaxOffset    = 65535;
+constexpr int         HashLog      = 12;
+constexpr std::size_t WildCopy     = 16;
+
+// ファイル構造(リトルエンディアン)
+//   0: マジックナンバー "GLZ\x1a"
+//   4: バージョン                     (4 bytes)
+//   8: ブロックサイズ                 (4 bytes)
+//  12: ブロック数                     (4 bytes)
+//  16: 展開後のサイズ                 (8 bytes)
+//  24: 索引の位置                     (8 bytes)
+//  32: 各ブロックの圧縮データ
+//  索引: (位置 8 bytes,サイズ 4 bytes(最上位ビットは無圧縮)) x ブロック数
+constexpr char          Magic[4]   = {'G', 'L', 'Z', '\x1a'};
+constexpr std::uint32_t Version    = 1;
+constexpr std::size_t   HeaderSize = 32;
+constexpr std::size_t   RecordSize = 12;
+constexpr std::uint32_t RawFlag    = 0x80000000u;
+constexpr std::size_t   MaxBlock   = 0x40000000u;
+
+std::uint32_t Load32(const std::uint8_t* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint64_t Load64(const std::uint8_t* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t Hash(std::uint32_t v) {
+    return (v * 2654435761u) >> (32 - HashLog);
+}
+
+// 一致長を8バイト単位で数える
+std::size_t Count(const std::uint8_t* p, const std::uint8_t* r, const std::uint8_t* limit) {
+    auto start = p;
+    while (p + 8 <= limit) {
+        auto diff = Load64(p) ^ Load64(r);
+        if (diff) {
+            return p - start + (std::endian::native == std::endian::little ? std::countr_zero(diff) : std::countl_zero(diff)) / 8;
+        }
+        p += 8;
+        r += 8;
+    }
+    while (p < limit && *p == *r) {
+        ++p;
+        ++r;
+    }
+    return p - start;
+}
+
+std::uint8_t* PutLength(std::uint8_t* op, std::size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = static_cast<std::uint8_t>(length);
+    return op;
+}
+
+std::uint64_t Get(const std::byte* data, std::size_t n) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < n; ++i) value |= static_cast<std::uint64_t>(data[i]) << (i * 8);
+    return value;
+}
+
+void Put(std::byte* data, std::uint64_t value, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) data[i] = static_cast<std::byte>(value >> (i * 8));
+}
+
+} // namespace
+
+std::size_t CompressBound(std::size_t size) {
+    return size + size / 255 + 16;
+}
+
+std::size_t CompressBlock(void* dst, std::size_t capacity, const void* src, std::size_t size) {
+    auto base   = static_cast<const std::uint8_t*>(src);
+    auto end    = base + size;
+    auto ip     = base;
+    auto anchor = base;
+    auto op     = static_cast<std::uint8_t*>(dst);
+    auto oend   = op + capacity;
+    auto emit   = [&](std::size_t literals) {
+        if (static_cast<std::size_t>(oend - op) < 1 + literals / 255 + 1 + literals) return false;
+        auto token = op++;
+        if (literals >= 15) {
+            *token = 15 << 4;
+            op = PutLength(op, literals - 15);
+        } else {
+            *token = static_cast<std::uint8_t>(literals << 4);
+        }
+        std::memcpy(op, anchor, literals);
+        op += literals;
+        return true;
+    };
+    if (size >= MatchLimit + 1) {
+        std::uint32_t table[1 << HashLog] = {};
+        auto mflimit    = end - MatchLimit;
+        auto matchlimit = end - LastLiterals;
+        ++ip;
+        while (ip <= mflimit) {
+            auto seq = Load32(ip);
+            auto h   = Hash(seq);
+            auto ref = base + table[h];
+            table[h] = static_cast<std::uint32_t>(ip - base);
+            if (ref >= ip || static_cast<std::size_t>(ip - ref) > MaxOffset || Load32(ref) != seq) {
+                ip += 1 + ((ip - anchor) >> 6); // 一致しない区間は徐々に読み飛ばす
+                continue;
+            }
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+            auto length = Count(ip + MinMatch, ref + MinMatch, matchlimit);
+            auto token  = op;
+            if (!emit(ip - anchor)) return 0;
+            if (static_cast<std::size_t>(oend - op) < 2 + length / 255 + 1) return 0;
+            auto offset = static_cast<std::size_t>(ip - ref);
+            *op++ = static_cast<std::uint8_t>(offset);
+            *op++ = static_cast<std::uint8_t>(offset >> 8);
+            if (length >= 15) {
+                *token |= 15;
+                op = PutLength(op, length - 15);
+            } else {
+                *token |= static_cast<std::uint8_t>(length);
+            }
+            ip    += MinMatch + length;
+            anchor = ip;
+            if (ip - 2 > base) table[Hash(Load32(ip - 2))] = static_cast<std::uint32_t>(ip - 2 - base);
+        }
+    }
+    if (!emit(end - anchor)) return 0;
+    return op - static_cast<std::uint8_t*>(dst);
+}
+
+std::size_t DecompressBlock(void* dst, std::size_t capacity, const void* src, std::size_t size) {
+    auto ip   = static_cast<const std::uint8_t*>(src);
+    auto iend = ip + size;
+    auto op   = static_cast<std::uint8_t*>(dst);
+    auto obeg = op;
+    auto oend = op + capacity;
+    auto fail = [] { throw std::runtime_error("DecompressBlock: Broken data."); };
+    auto length = [&](std::size_t value) {
+        if (value == 15) {
+            std::uint8_t b;
+            do {
+                if (ip >= iend) fail();
+                b      = *ip++;
+                value += b;
+            } while (b == 255);
+        }
+        return value;
+    };
+    while (ip < iend) {
+        auto token    = *ip++;
+        auto literals = length(token >> 4);
+        if (literals > static_cast<std::size_t>(iend - ip) || literals > static_cast<std::size_t>(oend - op)) fail();
+        if (static_cast<std::size_t>(iend - ip) >= literals + WildCopy && static_cast<std::size_t>(oend - op) >= literals + WildCopy) {
+            for (std::size_t i = 0; i < literals; i += WildCopy) std::memcpy(op + i, ip + i, WildCopy);
+        } else {
+            std::memcpy(op, ip, literals);
+        }
+        op += literals;
+        ip += literals;
+        if (ip == iend) break;
+        if (iend - ip < 2) fail();
+        auto offset = static_cast<std::size_t>(ip[0] | ip[1] << 8);
+        ip += 2;
+        auto match = length(token & 15) + MinMatch;
+        if (!offset || offset > static_cast<std::size_t>(op - obeg) || match > static_cast<std::size_t>(oend - op)) fail();
+        auto ref = op - offset;
+        if (offset >= WildCopy && static_cast<std::size_t>(oend - op) >= match + WildCopy) {
+            for (std::size_t i = 0; i < match; i += WildCopy) std::memcpy(op + i, ref + i, WildCopy);
+        } else if (offset >= match) {
+            std::memcpy(op, ref, match);
+        } else {
+            for (std::size_t i = 0; i < match; ++i) op[i] = ref[i];
+        }
+        op += match;
+    }
+    return op - obeg;
+}
+
+CompressedStream::CompressedStream(SharedStream stream, const std::string& mode, std::size_t blockSize) :
+Stream_   (stream),
+Base_     (stream->Tell()),
+BlockSize_(blockSize),
+RawSize_  (0),
+Position_ (0),
+Cached_   (~std::size_t(0)),
+Written_  (HeaderSize),
+Writable_ (mode == "w" || mode == "wb"),
+Open_     (true) {
+    if (!Writable_ && mode != "r" && mode != "rb") {
+        throw std::invalid_argument("CompressedStream: Unsupported mode.");
+    }
+    if (Writable_) {
+        if (!blockSize || blockSize > MaxBlock) {
+            throw std::invalid_argument("CompressedStream: Invalid block size.");
+        }
+        std::byte header[HeaderSize] = {};
+        if (Stream_->Write(header, sizeof(header)) < sizeof(header)) {
+            throw std::runtime_error("CompressedStream: Failed to write stream.");
+        }
+        Buffer_.reserve(BlockSize_);
+        Packed_.resize(CompressBound(BlockSize_));
+        return;
+    }
+    if (auto mapped = dynamic_cast<MappedStream*>(stream.get())) {
+        Mapping_ = mapped->Mapping().subspan(std::min(Base_, mapped->Mapping().size()));
+    }
+    auto read = [this](std::size_t offset, void* data, std::size_t size) {
+        if (!Mapping_.empty()) {
+            if (offset > Mapping_.size() || size > Mapping_.size() - offset) return false;
+            std::memcpy(data, Mapping_.data() + offset, size);
+            return true;
+        }
+        return Stream_->Seek(Base_ + offset) && Stream_->Read(data, size) == size;
+    };
+    std::byte header[HeaderSize];
+    if (!read(0, header, sizeof(header)) || std::memcmp(header, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("CompressedStream: Invalid signature.");
+    }
+    if (Get(header + 4, 4) != Version) {
+        throw std::runtime_error("CompressedStream: Unsupported version.");
+    }
+    BlockSize_ = Get(header +  8, 4);
+    RawSize_   = Get(header + 16, 8);
+    auto count = Get(header + 12, 4);
+    if (!BlockSize_ || BlockSize_ > MaxBlock || count != RawSize_ / BlockSize_ + (RawSize_ % BlockSize_ != 0)) {
+        throw std::runtime_error("CompressedStream: Broken header.");
+    }
+    // 壊れたヘッダで巨大な索引を確保しないように、ストリームに収まるかを先に確認する
+    auto available = Mapping_.empty() ? Stream_->Size() - std::min(Base_, Stream_->Size()) : Mapping_.size();
+    if (count > (available - HeaderSize) / RecordSize) {
+        throw std::runtime_error("CompressedStream: Broken header.");
+    }
+    std::vector<std::byte> index(count * RecordSize);
+    if (!read(Get(header + 24, 8), index.data(), index.size())) {
+        throw std::runtime_error("CompressedStream: Broken block index.");
+    }
+    Index_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto size = static_cast<std::uint32_t>(Get(index.data() + i * RecordSize + 8, 4));
+        Index_[i] = {Get(index.data() + i * RecordSize, 8), size & ~RawFlag, (size & RawFlag) != 0};
+    }
+    Buffer_.resize(BlockSize_);
+    Stream_->Seek(Base_);
+}
+
+CompressedStream::~CompressedStream() {
+    Close();
+}
+
+void CompressedStream::Close(void) {
+    if (!Open_) return;
+    Open_ = false;
+    if (!Writable_) return;
+    // 残りのブロックと索引を書き込み、ヘッダを更新する
+    if (!StoreBlock()) return;
+    std::vector<std::byte> index(Index_.size() * RecordSize);
+    for (std::size_t i = 0; i < Index_.size(); ++i) {
+        Put(index.data() + i * RecordSize,     Index_[i].Offset, 8);
+        Put(index.data() + i * RecordSize + 8, Index_[i].Size | (Index_[i].Raw ? RawFlag : 0), 4);
+    }
+    if (Stream_->Write(index.data(), index.size()) < index.size()) return;
+    std::byte header[HeaderSize] = {};
+    std::memcpy(header, Magic, sizeof(Magic));
+    Put(header +  4, Version,       4);
+    Put(header +  8, BlockSize_,    4);
+    Put(header + 12, Index_.size(), 4);
+    Put(header + 16, RawSize_,      8);
+    Put(header + 24, Written_,      8);
+    if (Stream_->Seek(Base_) && Stream_->Write(header, sizeof(header)) == sizeof(header)) {
+        Stream_->Seek(Base_ + Written_ + index.size());
+    }
+}
+
+bool CompressedStream::Flush(void) {
+    return Open_ && Stream_->Flush();
+}
+
+std::size_t CompressedStream::Read(void* data, std::size_t size) {
+    if (!Open_ || !data || Writable_) return 0;
+    auto out   = static_cast<std::byte*>(data);
+    auto total = std::size_t(0);
+    while (total < size && Position_ < RawSize_) {
+        auto block = Position_ / BlockSize_;
+        if (!LoadBlock(block)) break;
+        auto offset = Position_ - block * BlockSize_;
+        auto n      = std::min(size - total, std::min(BlockSize_, RawSize_ - block * BlockSize_) - offset);
+        std::memcpy(out + total, Buffer_.data() + offset, n);
+        Position_ += n;
+        total     += n;
+    }
+    return total;
+}
+
+std::size_t CompressedStream::ReadAt(std::size_t offset, void* data, std::size_t size) {
+    if (!Open_ || !data || Writable_) return 0;
+    // 読み込み中のブロックは共有し、それ以外はこの呼び出しのバッファに展開する
+    auto out   = static_cast<std::byte*>(data);
+    auto total = std::size_t(0);
+    std::vector<std::byte> buffer, packed;
+    while (total < size && offset < RawSize_) {
+        auto block  = offset / BlockSize_;
+        auto begin  = offset - block * BlockSize_;
+        auto n      = std::min(size - total, std::min(BlockSize_, RawSize_ - block * BlockSize_) - begin);
+        auto source = Buffer_.data();
+        if (Cached_ != block) {
+            buffer.resize(BlockSize_);
+            if (!DecodeBlock(block, buffer.data(), packed)) break;
+            source = buffer.data();
+        }
+        std::memcpy(out + total, source + begin, n);
+        offset += n;
+        total  += n;
+    }
+    return total;
+}
+
+std::size_t CompressedStream::Write(const void* data, std::size_t size) {
+    if (!Open_ || !data || !Writable_) return 0;
+    auto in    = static_cast<const std::byte*>(data);
+    auto total = std::size_t(0);
+    while (total < size) {
+        auto n = std::min(size - total, BlockSize_ - Buffer_.size());
+        Buffer_.insert(Buffer_.end(), in + total, in + total + n);
+        total += n;
+        if (Buffer_.size() == BlockSize_ && !StoreBlock()) break;
+    }
+    Position_ += total;
+    RawSize_  += total;
+    return total;
+}
+
+bool CompressedStream::Seek(std::size_t offset) {
+    if (!Open_ || (Writable_ && offset != Position_)) return false;
+    Position_ = offset;
+    return true;
+}
+
+std::size_t CompressedStream::Tell(void) const {
+    return Open_ ? Position_ : 0;
+}
+
+std::size_t CompressedStream::Size(void) const {
+    return Open_ ? RawSize_ : 0;
+}
+
+bool CompressedStream::LoadBlock(std::size_t index) {
+    if (Cached_ == index) return true;
+    Cached_ = ~std::size_t(0);
+    if (!DecodeBlock(index, Buffer_.data(), Packed_)) return false;
+    Cached_ = index;
+    return true;
+}
+
+bool CompressedStream::DecodeBlock(std::size_t index, std::byte* data, std::vector<std::byte>& packed) const {
+    auto& block = Index_[index];
+    auto  raw   = std::min(BlockSize_, RawSize_ - index * BlockSize_);
+    const std::byte* source;
+    if (!Mapping_.empty()) {
+        if (block.Offset > Mapping_.size() || block.Size > Mapping_.size() - block.Offset) return false;
+        source = Mapping_.data() + block.Offset;
+    } else {
+        packed.resize(block.Size);
+        if (Stream_->ReadAt(Base_ + block.Offset, packed.data(), block.Size) < block.Size) return false;
+        source = packed.data();
+    }
+    if (block.Raw) {
+        if (block.Size != raw) return false;
+        std::memcpy(data, source, raw);
+    } else if (DecompressBlock(data, raw, source, block.Size) != raw) {
+        throw std::runtime_error("CompressedStream: Broken block.");
+    }
+    return true;
+}
+
+bool CompressedStream::StoreBlock(void) {
+    if (Buffer_.empty()) return true;
+    auto size = CompressBlock(Packed_.data(), Buffer_.size() - 1, Buffer_.data(), Buffer_.size());
+    auto raw  = size == 0;
+    auto data = raw ? Buffer_.data() : Packed_.data();
+    if (raw) size = Buffer_.size();
+    if (Stream_->Write(data, size) < size) return false;
+    Index_.push_back({Written_, static_cast<std::uint32_t>(size), raw});
+    Written_ += size;
+    Buffer_.clear();
+    return true;
+}
+
+} // namespace Graphene::Stream
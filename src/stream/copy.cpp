@@ -0,0 +1,111 @@
+/** @file
+ * @brief ストリームコピー
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/copy.hpp>
+#include <graphene/stream/async.hpp>
+#include <graphene/stream/mapped.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
+namespace Graphene::Stream {
+
+namespace {
+
+constexpr std::size_t BufferSize  = 1024 * 1024;
+constexpr std::size_t KernelChunk = 1024 * 1024 * 1024; // 1回のシステムコールでコピーする最大サイズ
+
+#ifdef __linux__
+// カーネル内でコピーする(未対応の組み合わせで何もコピーしていない場合はfalseを返す)
+bool CopyKernel(int output, off_t& outOffset, int input, off_t& inOffset, std::size_t size, std::size_t& copied) {
+    auto useRange = true;
+    while (copied < size) {
+        auto count = std::min(size - copied, KernelChunk);
+        ssize_t n;
+        if (useRange) {
+            n = copy_file_range(input, &inOffset, output, &outOffset, count, 0);
+            if (n < 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF)) {
+                // sendfileは出力側のファイルオフセットを使用する
+                if (lseek(output, outOffset, SEEK_SET) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "CopyStream");
+                }
+                useRange = false;
+                continue;
+            }
+        } else {
+            n = sendfile(output, input, &inOffset, count);
+            if (n > 0) outOffset += n;
+            if (n < 0 && !copied && (errno == EINVAL || errno == ENOSYS)) return false;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::system_error(errno, std::generic_category(), "CopyStream");
+        if (n == 0) break;
+        copied += n;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+CopyResult CopyStream(SharedStream output, SharedStream input, std::size_t size) {
+    auto start  = std::chrono::steady_clock::now();
+    auto result = CopyResult{0, 0.0, 0.0, CopyMethodBuffer};
+    auto write  = [&output](const void* data, std::size_t count) {
+        if (output->Write(data, count) < count) {
+            throw std::runtime_error("CopyStream: Failed to write stream.");
+        }
+    };
+#ifdef __linux__
+    auto in  = dynamic_cast<DescriptorStream*>(input.get());
+    auto out = dynamic_cast<DescriptorStream*>(output.get());
+    if (in && out && output->Flush()) {
+        // stdioのバッファを迂回するため、明示した位置でコピーしてからストリームポインタを合わせる
+        auto inOffset  = static_cast<off_t>(input->Tell());
+        auto outOffset = static_cast<off_t>(output->Tell());
+        auto copied    = std::size_t(0);
+        if (CopyKernel(out->Descriptor(), outOffset, in->Descriptor(), inOffset, size, copied)) {
+            input->Seek(inOffset);
+            output->Seek(outOffset);
+            result.Size   = copied;
+            result.Method = CopyMethodKernel;
+        }
+    }
+#endif
+    if (result.Method != CopyMethodKernel) {
+        if (auto mapped = dynamic_cast<MappedStream*>(input.get())) {
+            auto mapping = mapped->Mapping();
+            auto offset  = std::min(input->Tell(), mapping.size());
+            auto count   = std::min(size, mapping.size() - offset);
+            write(mapping.data() + offset, count);
+            input->Seek(offset + count);
+            result.Size   = count;
+            result.Method = CopyMethodMapping;
+        } else {
+            std::vector<std::byte> buffer(std::min(size, BufferSize));
+            while (result.Size < size) {
+                auto n = input->Read(buffer.data(), std::min(size - result.Size, buffer.size()));
+                if (!n) break;
+                write(buffer.data(), n);
+                result.Size += n;
+            }
+        }
+    }
+    result.Seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.Throughput = result.Seconds > 0.0 ? result.Size / result.Seconds : 0.0;
+    return result;
+}
+
+} // namespace Graphene::Stream
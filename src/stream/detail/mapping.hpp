@@ -0,0 +1,178 @@
+/** @file
+ * @brief ファイルマッピング
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_DETAIL_MAPPING_HPP
+#define GRAPHENE_STREAM_DETAIL_MAPPING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <graphene/stream/stream.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Graphene::Stream::Detail {
+
+/**
+ * @brief ファイルマッピングクラス
+ *
+ * ファイル全体を読み込み専用でメモリにマップします。 @n
+ * マップしたメモリはオブジェクトの削除と同時に解放されます。
+ */
+class FileMapping final {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] path ファイルパス
+     * @throw std::system_error ファイルマップ失敗
+     */
+    explicit FileMapping(const std::string& path) :
+    Data_(nullptr),
+    Size_(0) {
+#ifdef _WIN32
+        auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::system_error(GetLastError(), std::system_category(), path);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            auto error = GetLastError();
+            CloseHandle(file);
+            throw std::system_error(error, std::system_category(), path);
+        }
+        Size_ = static_cast<std::size_t>(size.QuadPart);
+        if (Size_) {
+            auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            auto error   = GetLastError();
+            if (mapping) {
+                Data_ = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                error = GetLastError();
+                CloseHandle(mapping);
+            }
+            if (!Data_) {
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), path);
+            }
+        }
+        CloseHandle(file);
+#else
+        auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        struct stat s;
+        if (fstat(fd, &s) != 0) {
+            auto error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        Size_ = static_cast<std::size_t>(s.st_size);
+        if (Size_) {
+            auto data = mmap(nullptr, Size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), path);
+            }
+            Data_ = static_cast<const std::byte*>(data);
+        }
+        close(fd);
+#endif
+    }
+
+    /**
+     * @brief デストラクタ
+     */
+    ~FileMapping() {
+        if (Data_) {
+#ifdef _WIN32
+            UnmapViewOfFile(Data_);
+#else
+            munmap(const_cast<std::byte*>(Data_), Size_);
+#endif
+        }
+    }
+
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    /**
+     * @brief データの取得
+     *
+     * マップしたメモリの先頭アドレスを取得します。 @n
+     * 空のファイルの場合はnullptrを返します。
+     *
+     * @return 先頭アドレス
+     */
+    const std::byte* Data(void) const noexcept {
+        return Data_;
+    }
+
+    /**
+     * @brief サイズの取得
+     *
+     * マップしたメモリのサイズを取得します。
+     *
+     * @return サイズ(bytes)
+     */
+    std::size_t Size(void) const noexcept {
+        return Size_;
+    }
+
+    /**
+     * @brief アクセスパターンのヒントを通知
+     *
+     * マップしたメモリの範囲にmadviseでヒントを通知します。 @n
+     * sizeが0の場合はoffsetから終端までを対象にします。
+     *
+     * @param [in] hint   アクセスパターンのヒント
+     * @param [in] offset 対象範囲の先頭からの位置(bytes)
+     * @param [in] size   対象範囲のサイズ(bytes)
+     * @retval true  成功
+     * @retval false 失敗または未対応
+     */
+    bool Advise(AccessHint hint, std::size_t offset, std::size_t size) const noexcept {
+#ifdef _WIN32
+        return false;
+#else
+        if (!Data_ || offset >= Size_) return false;
+        auto end = size ? offset + std::min(size, Size_ - offset) : Size_;
+        if (hint == AccessHintNormal || hint == AccessHintSequential || hint == AccessHintRandom) {
+            offset = 0;
+            end    = Size_;
+        }
+        auto page  = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        auto first = offset / page * page;
+        auto advice = MADV_NORMAL;
+        switch (hint) {
+        case AccessHintSequential: advice = MADV_SEQUENTIAL; break;
+        case AccessHintRandom:     advice = MADV_RANDOM;     break;
+        case AccessHintWillNeed:   advice = MADV_WILLNEED;   break;
+        case AccessHintDontNeed:   advice = MADV_DONTNEED;   break;
+        default:                                             break;
+        }
+        return madvise(const_cast<std::byte*>(Data_) + first, end - first, advice) == 0;
+#endif
+    }
+
+private:
+    const std::byte* Data_;
+    std::size_t      Size_;
+};
+
+} // namespace Graphene::Stream::Detail
+
+#endif // GRAPHENE_STREAM_DETAIL_MAPPING_HPP
@@ -0,0 +1,52 @@
+/** @file
+ * @brief オープンモード
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_DETAIL_MODE_HPP
+#define GRAPHENE_STREAM_DETAIL_MODE_HPP
+
+#include <algorithm>
+#include <string>
+
+namespace Graphene::Stream::Detail {
+
+/**
+ * @brief "d"オプションの判定
+ *
+ * @param [in] mode オープンモード
+ * @return "d"オプションが含まれる場合はtrue
+ */
+inline bool IsDirectMode(const std::string& mode) {
+    return mode.find('d') != std::string::npos;
+}
+
+/**
+ * @brief "d"オプションの除去
+ *
+ * @param [in] mode オープンモード
+ * @return "d"オプションを取り除いたオープンモード
+ */
+inline std::string StripDirectMode(std::string mode) {
+    mode.erase(std::remove(mode.begin(), mode.end(), 'd'), mode.end());
+    return mode;
+}
+
+/**
+ * @brief 読み込み専用モードの判定
+ *
+ * "d"オプションは無視して判定します。
+ *
+ * @param [in] mode オープンモード
+ * @return "r"または"rb"の場合はtrue
+ */
+inline bool IsReadMode(const std::string& mode) {
+    auto base = StripDirectMode(mode);
+    return base == "r" || base == "rb";
+}
+
+} // namespace Graphene::Stream::Detail
+
+#endif // GRAPHENE_STREAM_DETAIL_MODE_HPP
@@ -0,0 +1,105 @@
+/** @file
+ * @brief ワーカースレッド
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_STREAM_DETAIL_WORKERS_HPP
+#define GRAPHENE_STREAM_DETAIL_WORKERS_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Graphene::Stream::Detail {
+
+/**
+ * @brief ワーカープールクラス
+ *
+ * 決まった数のスレッドで、要求された処理を順番に実行します。 @n
+ * スレッド数を超える要求はキューで待機するため、大量に要求してもスレッドは増えません。 @n
+ * 全ての関数はスレッドセーフです。
+ */
+class WorkerPool final {
+public:
+    /**
+     * @brief コンストラクタ
+     *
+     * @param [in] threads スレッド数(0の場合は1)
+     */
+    explicit WorkerPool(std::size_t threads) :
+    Stop_(false) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+            Threads_.emplace_back([this] { Run(); });
+        }
+    }
+
+    /**
+     * @brief デストラクタ
+     *
+     * キューに残っている処理を全て実行してからスレッドを終了します。
+     */
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex_);
+            Stop_ = true;
+        }
+        Condition_.notify_all();
+        for (auto& thread : Threads_) thread.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief 処理の要求
+     *
+     * @param [in] func 実行する関数
+     * @return 関数の戻り値または送出した例外を受け取るfuture
+     */
+    template<class F>
+    std::future<std::invoke_result_t<F>> Submit(F&& func) {
+        std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(func));
+        auto future = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(Mutex_);
+            Queue_.emplace_back(std::move(task));
+        }
+        Condition_.notify_one();
+        return future;
+    }
+
+private:
+    void Run(void) {
+        for (;;) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(Mutex_);
+                Condition_.wait(lock, [this] { return Stop_ || !Queue_.empty(); });
+                if (Queue_.empty()) return;
+                task = std::move(Queue_.front());
+                Queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::mutex                             Mutex_;
+    std::condition_variable                Condition_;
+    std::deque<std::packaged_task<void()>> Queue_;
+    std::vector<std::thread>               Threads_;
+    bool                                   Stop_;
+};
+
+} // namespace Graphene::Stream::Detail
+
+#endif // GRAPHENE_STREAM_DETAIL_WORKERS_HPP
@@ -6,13 +6,29 @@
  * or copy at https://opensource.org/licenses/MIT)
  */
 #include <graphene/stream/file.hpp>
+#include <graphene/stream/async.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <new>
+#include <stdexcept>
 #include <system_error>
 #include <cstdio>
 #include <sys/stat.h>
+#include "detail/mode.hpp"
+
+#ifndef _WIN32
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 namespace Graphene::Stream {
 
-class File final : public Stream {
+class File final : public Stream, public DescriptorStream {
 public:
     File(const std::string& path, const std::string& mode) :
     Handle_(std::fopen(path.c_str(), AddBinaryMode(mode).c_str())) {
@@ -40,10 +56,55 @@ public:
         return std::fread(data, 1, size, Handle_);
     }
 
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override {
+#ifdef _WIN32
+        return Stream::ReadAt(offset, data, size);
+#else
+        // stdioのバッファを経由せずに読み込むため、未書き出しのデータは参照されない
+        if (!Handle_ || !data) return 0;
+        auto out   = static_cast<char*>(data);
+        auto total = std::size_t(0);
+        while (total < size) {
+            auto n = pread(fileno(Handle_), out + total, size - total, offset + total);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            total += n;
+        }
+        return total;
+#endif
+    }
+
+    virtual std::size_t ReadV(std::size_t offset, std::span<const ReadBuffer> buffers) override {
+#ifdef _WIN32
+        return Stream::ReadV(offset, buffers);
+#else
+        if (!Handle_) return 0;
+        std::vector<iovec> vectors;
+        for (auto& buffer : buffers) vectors.push_back({buffer.Data, buffer.Size});
+        return Transfer(vectors, offset, [this](const iovec* v, int n, off_t o) { return preadv(fileno(Handle_), v, n, o); });
+#endif
+    }
+
+    using Stream::ReadV;
+
     virtual std::size_t Write(const void* data, std::size_t size) override {
         return std::fwrite(data, 1, size, Handle_);
     }
 
+    virtual std::size_t WriteV(std::size_t offset, std::span<const WriteBuffer> buffers) override {
+#ifdef _WIN32
+        return Stream::WriteV(offset, buffers);
+#else
+        // stdioのバッファに残っているデータを先に書き出してから書き込む
+        if (!Handle_ || std::fflush(Handle_) != 0) return 0;
+        std::vector<iovec> vectors;
+        for (auto& buffer : buffers) vectors.push_back({const_cast<void*>(buffer.Data), buffer.Size});
+        return Transfer(vectors, offset, [this](const iovec* v, int n, off_t o) { return pwritev(fileno(Handle_), v, n, o); });
+#endif
+    }
+
+    using Stream::WriteV;
+
     virtual bool Seek(std::size_t offset) override {
         return std::fseek(Handle_, offset, SEEK_SET) == 0;
     }
@@ -57,7 +118,56 @@ public:
         return fstat(fileno(Handle_), &s) == 0 ? s.st_size : 0;
     }
 
+    virtual bool Advise(AccessHint hint, std::size_t offset, std::size_t size) override {
+#ifdef _WIN32
+        return false;
+#else
+        if (!Handle_) return false;
+        auto advice = POSIX_FADV_NORMAL;
+        switch (hint) {
+        case AccessHintSequential: advice = POSIX_FADV_SEQUENTIAL; break;
+        case AccessHintRandom:     advice = POSIX_FADV_RANDOM;     break;
+        case AccessHintWillNeed:   advice = POSIX_FADV_WILLNEED;   break;
+        case AccessHintDontNeed:   advice = POSIX_FADV_DONTNEED;   break;
+        default:                                                   break;
+        }
+        return posix_fadvise(fileno(Handle_), offset, size, advice) == 0;
+#endif
+    }
+
+    virtual int Descriptor(void) const override {
+        return Handle_ ? fileno(Handle_) : -1;
+    }
+
 private:
+#ifndef _WIN32
+    // 途中で中断された分を再開しながら全てのベクタを転送する
+    template<class F>
+    std::size_t Transfer(std::vector<iovec>& vectors, std::size_t offset, F&& func) {
+        auto total = std::size_t(0);
+        auto first = std::size_t(0);
+        while (first < vectors.size()) {
+            if (!vectors[first].iov_len) {
+                ++first;
+                continue;
+            }
+            auto count = static_cast<int>(std::min<std::size_t>(vectors.size() - first, IOV_MAX));
+            auto n     = func(vectors.data() + first, count, static_cast<off_t>(offset + total));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            total += n;
+            for (auto rest = static_cast<std::size_t>(n); rest; ) {
+                auto step = std::min(rest, vectors[first].iov_len);
+                vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + step;
+                vectors[first].iov_len -= step;
+                rest -= step;
+                if (!vectors[first].iov_len) ++first;
+            }
+        }
+        return total;
+    }
+#endif
+
     std::string AddBinaryMode(const std::string& mode) {
         return mode.find('b') == std::string::npos ? mode + 'b' : mode;
     }
@@ -66,8 +176,200 @@ private:
     FILE* Handle_;
 };
 
+namespace {
+
+#ifndef _WIN32
+// ページキャッシュを経由せずに読み込むファイル(読み込み専用)
+class DirectFile final : public Stream {
+public:
+    DirectFile(const std::string& path) :
+    Handle_  (open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT)),
+    Buffer_  (static_cast<std::byte*>(::operator new(WindowSize, std::align_val_t(Align)))),
+    Base_    (0),
+    Fill_    (0),
+    Position_(0) {
+        if (Handle_ < 0 && errno == EINVAL) {
+            // O_DIRECTに未対応のファイルシステムでは、読み込み後にキャッシュを解放する
+            Handle_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (Handle_ < 0) {
+            auto error = errno;
+            ::operator delete(Buffer_, std::align_val_t(Align));
+            throw std::system_error(error, std::generic_category(), path);
+        }
+    }
+
+    virtual ~DirectFile() override {
+        Close();
+        ::operator delete(Buffer_, std::align_val_t(Align));
+    }
+
+    virtual void Close(void) override {
+        if (Handle_ >= 0) {
+            close(Handle_);
+            Handle_ = -1;
+        }
+        Base_ = Fill_ = Position_ = 0;
+    }
+
+    virtual bool Flush(void) override {
+        return Handle_ >= 0;
+    }
+
+    virtual std::size_t Read(void* data, std::size_t size) override {
+        if (Handle_ < 0 || !data) return 0;
+        auto out   = static_cast<std::byte*>(data);
+        auto total = std::size_t(0);
+        while (total < size) {
+            if (Position_ >= Base_ && Position_ < Base_ + Fill_) {
+                auto n = std::min(Base_ + Fill_ - Position_, size - total);
+                std::memcpy(out + total, Buffer_ + (Position_ - Base_), n);
+                Position_ += n;
+                total     += n;
+                continue;
+            }
+            if (size - total >= WindowSize) {
+                auto n = ReadAt(Position_, out + total, size - total);
+                Position_ += n;
+                total     += n;
+                break;
+            }
+            if (!FillWindow(Position_)) break;
+        }
+        return total;
+    }
+
+    virtual std::span<const std::byte> Peek(std::size_t size) override {
+        if (Handle_ < 0 || size > WindowSize - Align) return Stream::Peek(size);
+        if (Position_ < Base_ || Position_ + size > Base_ + Fill_) FillWindow(Position_);
+        auto offset = std::min(Position_ - Base_, Fill_);
+        return {Buffer_ + offset, std::min(size, Fill_ - offset)};
+    }
+
+    // 境界に揃った部分はユーザーのメモリへ直接読み込み、揃っていない先頭と末尾は境界に揃えたバッファを経由する
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override {
+        if (Handle_ < 0 || !data) return 0;
+        auto out   = static_cast<std::byte*>(data);
+        auto total = std::size_t(0);
+        std::unique_ptr<std::byte, AlignedDelete> bounce;
+        while (total < size) {
+            auto position = offset + total;
+            auto rest     = size - total;
+            auto skip     = position & (Align - 1);
+            std::size_t n;
+            if (!skip && !(reinterpret_cast<std::uintptr_t>(out + total) & (Align - 1)) && rest >= Align) {
+                n = Transfer(out + total, rest & ~(Align - 1), position);
+                if (!n) break;
+            } else {
+                if (!bounce) bounce.reset(static_cast<std::byte*>(::operator new(BounceSize, std::align_val_t(Align))));
+                auto length = std::min((skip + rest + Align - 1) & ~(Align - 1), BounceSize);
+                auto got    = Transfer(bounce.get(), length, position - skip);
+                if (got <= skip) break;
+                n = std::min(got - skip, rest);
+                std::memcpy(out + total, bounce.get() + skip, n);
+                if (got < length) return total + n; // 終端
+            }
+            total += n;
+        }
+        return total;
+    }
+
+    virtual std::size_t Write(const void* data, std::size_t size) override {
+        return 0;
+    }
+
+    virtual bool Seek(std::size_t offset) override {
+        if (Handle_ < 0) return false;
+        Position_ = offset;
+        return true;
+    }
+
+    virtual std::size_t Tell(void) const override {
+        return Handle_ >= 0 ? Position_ : 0;
+    }
+
+    virtual std::size_t Size(void) const override {
+        struct stat s;
+        return Handle_ >= 0 && fstat(Handle_, &s) == 0 ? s.st_size : 0;
+    }
+
+private:
+    static constexpr std::size_t Align      = 4096;        // 論理ブロックサイズの上限として想定する境界
+    static constexpr std::size_t WindowSize = 1024 * 1024; // 順次読み込み用のバッファサイズ
+    static constexpr std::size_t BounceSize = 256 * 1024;  // 位置指定読み込みで境界を揃えるためのバッファサイズ
+
+    struct AlignedDelete {
+        void operator()(std::byte* p) const {
+            ::operator delete(p, std::align_val_t(Align));
+        }
+    };
+
+    // 境界に揃った位置とサイズで読み込み、ページキャッシュに残さない
+    std::size_t Transfer(std::byte* data, std::size_t size, std::size_t offset) {
+        auto total = std::size_t(0);
+        while (total < size) {
+            auto n = pread(Handle_, data + total, size - total, offset + total);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            total += n;
+            if (static_cast<std::size_t>(n) & (Align - 1)) break; // 終端
+        }
+        if (total) posix_fadvise(Handle_, offset, total, POSIX_FADV_DONTNEED);
+        return total;
+    }
+
+    bool FillWindow(std::size_t position) {
+        Base_ = position & ~(Align - 1);
+        Fill_ = Transfer(Buffer_, WindowSize, Base_);
+        return Fill_ > position - Base_;
+    }
+
+private:
+    int         Handle_;
+    std::byte*  Buffer_;
+    std::size_t Base_;     // バッファ先頭のファイル上の位置
+    std::size_t Fill_;     // バッファ内の有効なデータ量
+    std::size_t Position_;
+};
+#endif
+
+// オープンモードの'd'を解釈してファイルを開く
+SharedStream OpenFile(const std::string& path, const std::string& mode) {
+    if (!Detail::IsDirectMode(mode)) return std::make_shared<File>(path, mode);
+    if (!Detail::IsReadMode(mode)) {
+        throw std::invalid_argument("FileFactory: Direct I/O supports read mode only.");
+    }
+#ifdef _WIN32
+    return std::make_shared<File>(path, Detail::StripDirectMode(mode));
+#else
+    return std::make_shared<DirectFile>(path);
+#endif
+}
+
+} // namespace
+
 SharedStream FileFactory::Open(const std::string& path, const std::string& mode) {
-    return std::make_shared<File>(path, mode);
+    return OpenFile(path, mode);
+}
+
+DirectoryFactory::DirectoryFactory(const std::string& root) :
+Root_(root) {
+}
+
+SharedStream DirectoryFactory::Open(const std::string& path, const std::string& mode) {
+    return OpenFile((std::filesystem::path(Root_) / path).string(), mode);
+}
+
+std::vector<std::string> DirectoryFactory::Names(void) const {
+    std::vector<std::string> names;
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(Root_, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error)) {
+            names.push_back(it->path().lexically_relative(Root_).generic_string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
 }
 
 } // namespace Graphene::Stream
@@ -0,0 +1,104 @@
+/** @file
+ * @brief メモリマップファイル入力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/mapped.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "detail/mapping.hpp"
+#include "detail/mode.hpp"
+
+namespace Graphene::Stream {
+
+namespace {
+
+class MappedFile final : public Stream, public MappedStream {
+public:
+    MappedFile(const std::string& path) :
+    Mapping_ (path),
+    Position_(0),
+    Open_    (true) {
+    }
+
+    virtual void Close(void) override {
+        Open_ = false;
+    }
+
+    virtual bool Flush(void) override {
+        return Open_;
+    }
+
+    virtual std::size_t Read(void* data, std::size_t size) override {
+        if (!Open_ || !data) return 0;
+        size = std::min(size, Mapping_.Size() - std::min(Position_, Mapping_.Size()));
+        if (size) std::memcpy(data, Mapping_.Data() + Position_, size);
+        Position_ += size;
+        return size;
+    }
+
+    virtual std::span<const std::byte> Peek(std::size_t size) override {
+        if (!Open_) return {};
+        auto offset = std::min(Position_, Mapping_.Size());
+        return {Mapping_.Data() + offset, std::min(size, Mapping_.Size() - offset)};
+    }
+
+    virtual std::size_t Consume(std::size_t size) override {
+        if (!Open_) return 0;
+        size = std::min(size, Mapping_.Size() - std::min(Position_, Mapping_.Size()));
+        Position_ += size;
+        return size;
+    }
+
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override {
+        if (!Open_ || !data) return 0;
+        size = std::min(size, Mapping_.Size() - std::min(offset, Mapping_.Size()));
+        if (size) std::memcpy(data, Mapping_.Data() + offset, size);
+        return size;
+    }
+
+    virtual std::size_t Write(const void* data, std::size_t size) override {
+        return 0;
+    }
+
+    virtual bool Seek(std::size_t offset) override {
+        if (!Open_) return false;
+        Position_ = offset;
+        return true;
+    }
+
+    virtual std::size_t Tell(void) const override {
+        return Open_ ? Position_ : 0;
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Open_ ? Mapping_.Size() : 0;
+    }
+
+    virtual bool Advise(AccessHint hint, std::size_t offset, std::size_t size) override {
+        return Open_ && Mapping_.Advise(hint, offset, size);
+    }
+
+    virtual std::span<const std::byte> Mapping(void) const override {
+        return {Mapping_.Data(), Mapping_.Size()};
+    }
+
+private:
+    Detail::FileMapping Mapping_;
+    std::size_t         Position_;
+    bool                Open_;
+};
+
+} // namespace
+
+SharedStream MappedFileFactory::Open(const std::string& path, const std::string& mode) {
+    if (!Detail::IsReadMode(mode)) {
+        throw std::invalid_argument("MappedFileFactory: Unsupported mode.");
+    }
+    return std::make_shared<MappedFile>(path);
+}
+
+} // namespace Graphene::Stream
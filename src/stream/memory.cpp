@@ -0,0 +1,137 @@
+/** @file
+ * @brief メモリ入出力
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/memory.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include "detail/mode.hpp"
+#include "../resource.h"
+
+RESOURCE_EXTERN(graphics_shader_hlsl_test_vsh);
+RESOURCE_EXTERN(graphics_shader_hlsl_test_psh);
+
+namespace Graphene::Stream {
+
+MemoryStream::MemoryStream(std::vector<std::byte> data) :
+Buffer_  (std::move(data)),
+View_    (Buffer_),
+Position_(0),
+Writable_(true),
+Open_    (true) {
+}
+
+MemoryStream::MemoryStream(std::span<const std::byte> data) :
+View_    (data),
+Position_(0),
+Writable_(false),
+Open_    (true) {
+}
+
+void MemoryStream::Close(void) {
+    Open_ = false;
+}
+
+bool MemoryStream::Flush(void) {
+    return Open_;
+}
+
+std::size_t MemoryStream::Read(void* data, std::size_t size) {
+    if (!Open_ || !data) return 0;
+    size = std::min(size, View_.size() - std::min(Position_, View_.size()));
+    if (size) std::memcpy(data, View_.data() + Position_, size);
+    Position_ += size;
+    return size;
+}
+
+std::span<const std::byte> MemoryStream::Peek(std::size_t size) {
+    if (!Open_) return {};
+    auto offset = std::min(Position_, View_.size());
+    return View_.subspan(offset, std::min(size, View_.size() - offset));
+}
+
+std::size_t MemoryStream::Consume(std::size_t size) {
+    if (!Open_) return 0;
+    size = std::min(size, View_.size() - std::min(Position_, View_.size()));
+    Position_ += size;
+    return size;
+}
+
+std::size_t MemoryStream::ReadAt(std::size_t offset, void* data, std::size_t size) {
+    if (!Open_ || !data) return 0;
+    size = std::min(size, View_.size() - std::min(offset, View_.size()));
+    if (size) std::memcpy(data, View_.data() + offset, size);
+    return size;
+}
+
+std::size_t MemoryStream::Write(const void* data, std::size_t size) {
+    if (!Open_ || !data || !Writable_) return 0;
+    if (Position_ + size > Buffer_.size()) {
+        Buffer_.resize(Position_ + size);
+        View_ = Buffer_;
+    }
+    std::memcpy(Buffer_.data() + Position_, data, size);
+    Position_ += size;
+    return size;
+}
+
+bool MemoryStream::Seek(std::size_t offset) {
+    if (!Open_) return false;
+    Position_ = offset;
+    return true;
+}
+
+std::size_t MemoryStream::Tell(void) const {
+    return Open_ ? Position_ : 0;
+}
+
+std::size_t MemoryStream::Size(void) const {
+    return Open_ ? View_.size() : 0;
+}
+
+std::span<const std::byte> MemoryStream::Mapping(void) const {
+    return View_;
+}
+
+void ResourceFactory::Register(const std::string& name, std::span<const std::byte> data) {
+    std::lock_guard<std::mutex> lock(Mutex_);
+    Resources_[name] = data;
+}
+
+SharedStream ResourceFactory::Open(const std::string& path, const std::string& mode) {
+    if (!Detail::IsReadMode(mode)) {
+        throw std::invalid_argument("ResourceFactory: Unsupported mode.");
+    }
+    std::lock_guard<std::mutex> lock(Mutex_);
+    auto it = Resources_.find(path);
+    if (it == Resources_.end()) {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path);
+    }
+    return std::make_shared<MemoryStream>(it->second);
+}
+
+std::vector<std::string> ResourceFactory::Names(void) const {
+    std::lock_guard<std::mutex> lock(Mutex_);
+    std::vector<std::string> names;
+    names.reserve(Resources_.size());
+    for (auto& [name, data] : Resources_) names.push_back(name);
+    return names;
+}
+
+std::shared_ptr<ResourceFactory> GetBuiltinResources(void) {
+    // CMakeLists.txtのPROJECT_RESOURCESと対応させる
+    static const auto resources = [] {
+        auto factory = std::make_shared<ResourceFactory>();
+        factory->Register("graphics/shader/hlsl/test.vsh", RESOURCE_SPAN(graphics_shader_hlsl_test_vsh));
+        factory->Register("graphics/shader/hlsl/test.psh", RESOURCE_SPAN(graphics_shader_hlsl_test_psh));
+        return factory;
+    }();
+    return resources;
+}
+
+} // namespace Graphene::Stream
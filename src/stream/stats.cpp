@@ -0,0 +1,336 @@
+/** @file
+ * @brief 入出力統計
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/stats.hpp>
+#include <graphene/stream/async.hpp>
+#include <graphene/stream/mapped.hpp>
+#include <atomic>
+#include <bit>
+
+namespace Graphene::Stream {
+
+using Clock = std::chrono::steady_clock;
+
+struct Detail::StreamCounters {
+    using Histogram = std::array<std::atomic<std::uint64_t>, std::tuple_size_v<LatencyHistogram>>;
+
+    std::atomic<std::uint64_t> Opens        = 0;
+    std::atomic<std::uint64_t> OpenFailures = 0;
+    std::atomic<std::uint64_t> Reads        = 0;
+    std::atomic<std::uint64_t> Writes       = 0;
+    std::atomic<std::uint64_t> BytesRead    = 0;
+    std::atomic<std::uint64_t> BytesWritten = 0;
+    std::atomic<std::uint64_t> OpenTime     = 0;
+    std::atomic<std::uint64_t> ReadTime     = 0;
+    std::atomic<std::uint64_t> WriteTime    = 0;
+    Histogram                  OpenLatency  = {};
+    Histogram                  ReadLatency  = {};
+    Histogram                  WriteLatency = {};
+
+    static std::uint64_t Elapsed(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    static void Record(std::atomic<std::uint64_t>& total, Histogram& histogram, std::uint64_t time) {
+        auto bucket = std::min<std::size_t>(std::bit_width(time), histogram.size()) - (time ? 1 : 0);
+        total.fetch_add(time, std::memory_order_relaxed);
+        histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordRead(Clock::time_point start, std::size_t size) {
+        Reads.fetch_add(1, std::memory_order_relaxed);
+        BytesRead.fetch_add(size, std::memory_order_relaxed);
+        Record(ReadTime, ReadLatency, Elapsed(start));
+    }
+
+    void RecordWrite(Clock::time_point start, std::size_t size) {
+        Writes.fetch_add(1, std::memory_order_relaxed);
+        BytesWritten.fetch_add(size, std::memory_order_relaxed);
+        Record(WriteTime, WriteLatency, Elapsed(start));
+    }
+
+    void Accumulate(StreamStatistics& stats) const {
+        auto load = [](const std::atomic<std::uint64_t>& value) { return value.load(std::memory_order_relaxed); };
+        stats.Opens        += load(Opens);
+        stats.OpenFailures += load(OpenFailures);
+        stats.Reads        += load(Reads);
+        stats.Writes       += load(Writes);
+        stats.BytesRead    += load(BytesRead);
+        stats.BytesWritten += load(BytesWritten);
+        stats.OpenTime     += load(OpenTime);
+        stats.ReadTime     += load(ReadTime);
+        stats.WriteTime    += load(WriteTime);
+        for (std::size_t i = 0; i < stats.OpenLatency.size(); ++i) {
+            stats.OpenLatency[i]  += load(OpenLatency[i]);
+            stats.ReadLatency[i]  += load(ReadLatency[i]);
+            stats.WriteLatency[i] += load(WriteLatency[i]);
+        }
+    }
+
+    void Reset(void) {
+        for (auto value : {&Opens, &OpenFailures, &Reads, &Writes, &BytesRead, &BytesWritten, &OpenTime, &ReadTime, &WriteTime}) {
+            value->store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < OpenLatency.size(); ++i) {
+            OpenLatency[i].store(0, std::memory_order_relaxed);
+            ReadLatency[i].store(0, std::memory_order_relaxed);
+            WriteLatency[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace {
+
+using Counters = Detail::StreamCounters;
+
+class InstrumentedStream : public Stream {
+public:
+    InstrumentedStream(SharedStream stream, std::shared_ptr<Counters> counters) :
+    Stream_  (stream),
+    Counters_(counters) {
+    }
+
+    virtual void Close(void) override {
+        Stream_->Close();
+    }
+
+    virtual bool Flush(void) override {
+        return Stream_->Flush();
+    }
+
+    virtual std::size_t Read(void* data, std::size_t size) override {
+        auto start = Clock::now();
+        auto n     = Stream_->Read(data, size);
+        Counters_->RecordRead(start, n);
+        return n;
+    }
+
+    virtual std::span<const std::byte> Peek(std::size_t size) override {
+        auto start = Clock::now();
+        auto view  = Stream_->Peek(size);
+        Counters_->RecordRead(start, view.size());
+        return view;
+    }
+
+    virtual std::size_t Consume(std::size_t size) override {
+        return Stream_->Consume(size);
+    }
+
+    virtual std::size_t ReadAt(std::size_t offset, void* data, std::size_t size) override {
+        auto start = Clock::now();
+        auto n     = Stream_->ReadAt(offset, data, size);
+        Counters_->RecordRead(start, n);
+        return n;
+    }
+
+    virtual std::size_t ReadV(std::span<const ReadBuffer> buffers) override {
+        auto start = Clock::now();
+        auto n     = Stream_->ReadV(buffers);
+        Counters_->RecordRead(start, n);
+        return n;
+    }
+
+    virtual std::size_t ReadV(std::size_t offset, std::span<const ReadBuffer> buffers) override {
+        auto start = Clock::now();
+        auto n     = Stream_->ReadV(offset, buffers);
+        Counters_->RecordRead(start, n);
+        return n;
+    }
+
+    virtual std::size_t Write(const void* data, std::size_t size) override {
+        auto start = Clock::now();
+        auto n     = Stream_->Write(data, size);
+        Counters_->RecordWrite(start, n);
+        return n;
+    }
+
+    virtual std::size_t WriteV(std::span<const WriteBuffer> buffers) override {
+        auto start = Clock::now();
+        auto n     = Stream_->WriteV(buffers);
+        Counters_->RecordWrite(start, n);
+        return n;
+    }
+
+    virtual std::size_t WriteV(std::size_t offset, std::span<const WriteBuffer> buffers) override {
+        auto start = Clock::now();
+        auto n     = Stream_->WriteV(offset, buffers);
+        Counters_->RecordWrite(start, n);
+        return n;
+    }
+
+    virtual bool Seek(std::size_t offset) override {
+        return Stream_->Seek(offset);
+    }
+
+    virtual std::size_t Tell(void) const override {
+        return Stream_->Tell();
+    }
+
+    virtual std::size_t Size(void) const override {
+        return Stream_->Size();
+    }
+
+    virtual bool Advise(AccessHint hint, std::size_t offset, std::size_t size) override {
+        return Stream_->Advise(hint, offset, size);
+    }
+
+protected:
+    SharedStream              Stream_;
+    std::shared_ptr<Counters> Counters_;
+};
+
+class InstrumentedMappedStream final : public InstrumentedStream, public MappedStream {
+public:
+    InstrumentedMappedStream(SharedStream stream, std::shared_ptr<Counters> counters) :
+    InstrumentedStream(stream, counters) {
+    }
+
+    virtual std::span<const std::byte> Mapping(void) const override {
+        return dynamic_cast<const MappedStream&>(*Stream_).Mapping();
+    }
+};
+
+class InstrumentedDescriptorStream final : public InstrumentedStream, public DescriptorStream {
+public:
+    InstrumentedDescriptorStream(SharedStream stream, std::shared_ptr<Counters> counters) :
+    InstrumentedStream(stream, counters) {
+    }
+
+    virtual int Descriptor(void) const override {
+        return dynamic_cast<const DescriptorStream&>(*Stream_).Descriptor();
+    }
+};
+
+// ヒストグラムからパーセンタイルの上限(ns)を求める
+std::uint64_t Percentile(const LatencyHistogram& histogram, double ratio) {
+    std::uint64_t total = 0;
+    for (auto count : histogram) total += count;
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < histogram.size(); ++i) {
+        sum += histogram[i];
+        if (total && sum >= total * ratio) return std::uint64_t(2) << i;
+    }
+    return 0;
+}
+
+} // namespace
+
+InstrumentedFactory::InstrumentedFactory(SharedStreamFactory factory, std::size_t depth) :
+Factory_     (factory),
+Depth_       (depth),
+DumpStream_  (nullptr),
+DumpInterval_(0),
+DumpStop_    (false) {
+}
+
+InstrumentedFactory::~InstrumentedFactory() {
+    StopDump();
+}
+
+SharedStream InstrumentedFactory::Open(const std::string& path, const std::string& mode) {
+    auto counters = Find(path);
+    auto start    = Clock::now();
+    SharedStream stream;
+    try {
+        stream = Factory_->Open(path, mode);
+    } catch (...) {
+        counters->OpenFailures.fetch_add(1, std::memory_order_relaxed);
+        throw;
+    }
+    counters->Opens.fetch_add(1, std::memory_order_relaxed);
+    Counters::Record(counters->OpenTime, counters->OpenLatency, Counters::Elapsed(start));
+    if (dynamic_cast<MappedStream*>(stream.get())) {
+        return std::make_shared<InstrumentedMappedStream>(stream, counters);
+    }
+    if (dynamic_cast<DescriptorStream*>(stream.get())) {
+        return std::make_shared<InstrumentedDescriptorStream>(stream, counters);
+    }
+    return std::make_shared<InstrumentedStream>(stream, counters);
+}
+
+std::map<std::string, StreamStatistics> InstrumentedFactory::Statistics(void) const {
+    std::map<std::string, StreamStatistics> result;
+    std::shared_lock<std::shared_mutex> lock(Mutex_);
+    for (auto& [prefix, counters] : Counters_) {
+        counters->Accumulate(result[prefix] = {});
+    }
+    return result;
+}
+
+StreamStatistics InstrumentedFactory::Total(void) const {
+    StreamStatistics total = {};
+    std::shared_lock<std::shared_mutex> lock(Mutex_);
+    for (auto& [prefix, counters] : Counters_) counters->Accumulate(total);
+    return total;
+}
+
+void InstrumentedFactory::Reset(void) {
+    std::shared_lock<std::shared_mutex> lock(Mutex_);
+    for (auto& [prefix, counters] : Counters_) counters->Reset();
+}
+
+void InstrumentedFactory::Dump(std::ostream& out) const {
+    auto line = [&out](const std::string& prefix, const StreamStatistics& s) {
+        out << (prefix.empty() ? "/" : prefix)
+            << ": opens=" << s.Opens << " failed=" << s.OpenFailures
+            << " open-p50=" << Percentile(s.OpenLatency, 0.5) / 1000 << "us"
+            << " reads=" << s.Reads << " read-bytes=" << s.BytesRead << " read-ms=" << s.ReadTime / 1000000
+            << " read-p50=" << Percentile(s.ReadLatency, 0.5) / 1000 << "us"
+            << " read-p99=" << Percentile(s.ReadLatency, 0.99) / 1000 << "us"
+            << " writes=" << s.Writes << " write-bytes=" << s.BytesWritten << " write-ms=" << s.WriteTime / 1000000
+            << " write-p99=" << Percentile(s.WriteLatency, 0.99) / 1000 << "us\n";
+    };
+    for (auto& [prefix, stats] : Statistics()) line(prefix, stats);
+    line("total", Total());
+    out.flush();
+}
+
+void InstrumentedFactory::StartDump(std::ostream& out, std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(DumpMutex_);
+    DumpStream_   = &out;
+    DumpInterval_ = interval;
+    if (DumpThread_.joinable()) return;
+    DumpStop_   = false;
+    DumpThread_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(DumpMutex_);
+        while (!DumpCondition_.wait_for(lock, DumpInterval_, [this] { return DumpStop_; })) {
+            Dump(*DumpStream_);
+        }
+    });
+}
+
+void InstrumentedFactory::StopDump(void) {
+    {
+        std::lock_guard<std::mutex> lock(DumpMutex_);
+        DumpStop_ = true;
+    }
+    DumpCondition_.notify_all();
+    if (DumpThread_.joinable()) DumpThread_.join();
+}
+
+std::shared_ptr<Counters> InstrumentedFactory::Find(const std::string& path) {
+    auto end = std::size_t(0);
+    auto pos = std::size_t(path.starts_with('/') ? 1 : 0);
+    for (std::size_t i = 0; i < Depth_; ++i) {
+        auto next = path.find('/', pos);
+        if (next == std::string::npos) break;
+        end = next;
+        pos = next + 1;
+    }
+    auto prefix = path.substr(0, end);
+    {
+        std::shared_lock<std::shared_mutex> lock(Mutex_);
+        auto it = Counters_.find(prefix);
+        if (it != Counters_.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(Mutex_);
+    auto& counters = Counters_[prefix];
+    if (!counters) counters = std::make_shared<Counters>();
+    return counters;
+}
+
+} // namespace Graphene::Stream
@@ -0,0 +1,85 @@
+/** @file
+ * @brief 仮想ファイルシステム
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/vfs.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include "detail/mode.hpp"
+
+namespace Graphene::Stream {
+
+void VirtualFileSystem::Mount(SharedStreamFactory factory, int priority) {
+    if (!dynamic_cast<EnumerableFactory*>(factory.get())) {
+        throw std::invalid_argument("VirtualFileSystem: Not enumerable factory.");
+    }
+    std::unique_lock<std::shared_mutex> lock(Mutex_);
+    auto it = std::upper_bound(Mounts_.begin(), Mounts_.end(), priority, [](int p, const Mounted& m) { return p < m.Priority; });
+    Mounts_.insert(it, {factory, priority});
+    Rebuild();
+}
+
+void VirtualFileSystem::Unmount(SharedStreamFactory factory) {
+    std::unique_lock<std::shared_mutex> lock(Mutex_);
+    auto it = std::remove_if(Mounts_.begin(), Mounts_.end(), [&factory](const Mounted& m) { return m.Factory == factory; });
+    if (it == Mounts_.end()) return;
+    Mounts_.erase(it, Mounts_.end());
+    Rebuild();
+}
+
+void VirtualFileSystem::Refresh(void) {
+    std::unique_lock<std::shared_mutex> lock(Mutex_);
+    Rebuild();
+}
+
+SharedStream VirtualFileSystem::Open(const std::string& path, const std::string& mode) {
+    SharedStreamFactory factory;
+    // "d"オプションは解決したファクトリにそのまま渡す
+    auto read = Detail::IsReadMode(mode);
+    {
+        std::shared_lock<std::shared_mutex> lock(Mutex_);
+        if (read) {
+            auto it = Index_.find(path);
+            if (it != Index_.end()) factory = it->second;
+        } else if (!Mounts_.empty()) {
+            factory = Mounts_.back().Factory;
+        }
+    }
+    if (!factory) {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path);
+    }
+    auto stream = factory->Open(path, mode);
+    if (!read) {
+        std::unique_lock<std::shared_mutex> lock(Mutex_);
+        if (!Mounts_.empty() && Mounts_.back().Factory == factory) Index_[path] = factory;
+    }
+    return stream;
+}
+
+std::vector<std::string> VirtualFileSystem::Names(void) const {
+    std::vector<std::string> names;
+    {
+        std::shared_lock<std::shared_mutex> lock(Mutex_);
+        names.reserve(Index_.size());
+        for (auto& [name, factory] : Index_) names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// 優先度の低い順に登録して、優先度の高いファクトリで上書きする
+void VirtualFileSystem::Rebuild(void) {
+    std::unordered_map<std::string, SharedStreamFactory> index;
+    for (auto& mount : Mounts_) {
+        for (auto& name : dynamic_cast<EnumerableFactory&>(*mount.Factory).Names()) {
+            index[name] = mount.Factory;
+        }
+    }
+    Index_ = std::move(index);
+}
+
+} // namespace Graphene::Stream
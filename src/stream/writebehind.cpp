@@ -0,0 +1,182 @@
+/** @file
+ * @brief 非同期書き込み
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/writebehind.hpp>
+#include <graphene/stream/async.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Graphene::Stream {
+
+WriteBehindStream::WriteBehindStream(SharedStream stream, std::size_t size, std::size_t count) :
+Stream_     (stream),
+BufferSize_ (size),
+BufferCount_(count),
+Position_   (stream->Tell()),
+Busy_       (false),
+Failed_     (false),
+Written_    (false),
+Stop_       (false) {
+    if (!size || !count) {
+        throw std::invalid_argument("WriteBehindStream: Empty buffer.");
+    }
+    Current_.reserve(size);
+    Thread_ = std::thread([this] { Run(); });
+}
+
+WriteBehindStream::~WriteBehindStream() {
+    Submit();
+    {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        Stop_ = true;
+    }
+    Condition_.notify_all();
+    Thread_.join();
+}
+
+void WriteBehindStream::Close(void) {
+    Submit();
+    Wait();
+    Stream_->Close();
+    Position_ = 0;
+}
+
+bool WriteBehindStream::Flush(void) {
+    Submit();
+    Wait();
+    std::lock_guard<std::mutex> lock(Mutex_);
+    auto result = !Failed_;
+    Failed_    = false;
+    Written_   = false;
+    if (!Stream_->Flush()) return false;
+    // ディスクリプタを持つストリームはストレージへの書き込みの完了まで待機する
+    if (auto descriptor = dynamic_cast<DescriptorStream*>(Stream_.get()); descriptor && descriptor->Descriptor() >= 0) {
+#ifdef _WIN32
+        if (_commit(descriptor->Descriptor()) != 0) return false;
+#else
+        if (fsync(descriptor->Descriptor()) != 0) return false;
+#endif
+    }
+    return result;
+}
+
+std::size_t WriteBehindStream::Read(void* data, std::size_t size) {
+    if (!data) return 0;
+    Submit();
+    Wait();
+    auto n = Stream_->Read(data, size);
+    Position_ += n;
+    return n;
+}
+
+std::size_t WriteBehindStream::ReadAt(std::size_t offset, void* data, std::size_t size) {
+    if (!data) return 0;
+    Wait();
+    {
+        // 元のストリームのバッファに残っているデータを位置指定の読み込みから見えるようにする
+        std::lock_guard<std::mutex> lock(Mutex_);
+        if (Written_) {
+            Stream_->Flush();
+            Written_ = false;
+        }
+    }
+    auto n = Stream_->ReadAt(offset, data, size);
+    // キューに渡していないデータは元のストリームより新しい
+    auto base = Position_ - Current_.size();
+    if (Current_.empty() || offset >= Position_ || offset + size <= base) return n;
+    auto begin = std::max(offset, base);
+    auto end   = std::min(offset + size, Position_);
+    // 元のストリームの終端から書き込み中のバッファまでの間は0で埋める
+    if (offset + n < begin) std::memset(static_cast<std::byte*>(data) + n, 0, begin - offset - n);
+    std::memcpy(static_cast<std::byte*>(data) + (begin - offset), Current_.data() + (begin - base), end - begin);
+    return std::max(n, end - offset);
+}
+
+std::size_t WriteBehindStream::Write(const void* data, std::size_t size) {
+    if (!data) return 0;
+    {
+        std::lock_guard<std::mutex> lock(Mutex_);
+        if (Failed_) return 0;
+    }
+    auto in    = static_cast<const std::byte*>(data);
+    auto total = std::size_t(0);
+    while (total < size) {
+        auto n = std::min(BufferSize_ - Current_.size(), size - total);
+        Current_.insert(Current_.end(), in + total, in + total + n);
+        total += n;
+        if (Current_.size() == BufferSize_) Submit();
+    }
+    Position_ += size;
+    return size;
+}
+
+bool WriteBehindStream::Seek(std::size_t offset) {
+    Submit();
+    Wait();
+    auto result = Stream_->Seek(offset);
+    Position_ = Stream_->Tell();
+    return result;
+}
+
+std::size_t WriteBehindStream::Tell(void) const {
+    return Position_;
+}
+
+std::size_t WriteBehindStream::Size(void) const {
+    Wait();
+    return std::max(Stream_->Size(), Position_);
+}
+
+void WriteBehindStream::Submit(void) {
+    if (Current_.empty()) return;
+    std::unique_lock<std::mutex> lock(Mutex_);
+    Condition_.wait(lock, [this] { return Queue_.size() < BufferCount_; });
+    Queue_.push_back(std::move(Current_));
+    if (Free_.empty()) {
+        Current_ = {};
+        Current_.reserve(BufferSize_);
+    } else {
+        Current_ = std::move(Free_.back());
+        Free_.pop_back();
+    }
+    lock.unlock();
+    Condition_.notify_all();
+}
+
+void WriteBehindStream::Wait(void) const {
+    std::unique_lock<std::mutex> lock(Mutex_);
+    Condition_.wait(lock, [this] { return Queue_.empty() && !Busy_; });
+}
+
+void WriteBehindStream::Run(void) {
+    std::unique_lock<std::mutex> lock(Mutex_);
+    for (;;) {
+        Condition_.wait(lock, [this] { return Stop_ || !Queue_.empty(); });
+        if (Queue_.empty()) return;
+        auto buffer = std::move(Queue_.front());
+        Queue_.pop_front();
+        Busy_ = true;
+        lock.unlock();
+        auto failed = Stream_->Write(buffer.data(), buffer.size()) < buffer.size();
+        buffer.clear();
+        lock.lock();
+        Failed_    = Failed_ || failed;
+        Busy_      = false;
+        Written_   = true;
+        Free_.push_back(std::move(buffer));
+        Condition_.notify_all();
+    }
+}
+
+} // namespace Graphene::Stream
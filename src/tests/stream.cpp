@@ -0,0 +1,155 @@
+/** @file
+ * @brief ストリームの回帰テスト
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/archive.hpp>
+#include <graphene/stream/buffered.hpp>
+#include <graphene/stream/file.hpp>
+#include <graphene/stream/memory.hpp>
+#include <graphene/stream/writebehind.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace Graphene::Stream;
+
+int Failures = 0;
+
+void Check(bool condition, const char* message) {
+    if (condition) return;
+    std::cerr << "FAILED: " << message << std::endl;
+    ++Failures;
+}
+
+// ReadAtを実装せず既定の実装を使用するストリーム
+class PlainStream final : public Stream {
+public:
+    explicit PlainStream(SharedStream stream) : Stream_(stream) {}
+    virtual void Close(void) override { Stream_->Close(); }
+    virtual bool Flush(void) override { return Stream_->Flush(); }
+    virtual std::size_t Read(void* data, std::size_t size) override { return Stream_->Read(data, size); }
+    virtual std::size_t Write(const void* data, std::size_t size) override { return Stream_->Write(data, size); }
+    virtual bool Seek(std::size_t offset) override { return Stream_->Seek(offset); }
+    virtual std::size_t Tell(void) const override { return Stream_->Tell(); }
+    virtual std::size_t Size(void) const override { return Stream_->Size(); }
+
+private:
+    SharedStream Stream_;
+};
+
+std::vector<std::byte> Pattern(std::size_t size) {
+    std::vector<std::byte> data(size);
+    for (std::size_t i = 0; i < size; ++i) data[i] = std::byte((i * 131 + i / 977) & 0xFF);
+    return data;
+}
+
+// 圧縮エントリを含むアーカイブを作成する
+std::shared_ptr<MemoryStream> MakeArchive(const std::vector<std::byte>& data) {
+    auto resources = std::make_shared<ResourceFactory>();
+    resources->Register("packed", data);
+    resources->Register("stored", data);
+    auto archive = std::make_shared<MemoryStream>();
+    SaveArchive(archive, resources, {{"packed", "packed", true}, {"stored", "stored", false}});
+    archive->Seek(0);
+    return archive;
+}
+
+// 入れ子になったストリームのReadAtがロックを二重に取得しないことを確認する
+void TestNestedReadAt(const std::string& label, std::function<SharedStream(SharedStream)> wrap) {
+    auto data    = Pattern(300 * 1024);
+    auto factory = ArchiveFactory(wrap(MakeArchive(data)));
+    for (auto name : {"packed", "stored"}) {
+        auto entry = factory.Open(name, "r");
+        std::byte buffer[16];
+        Check(entry->ReadAt(10, buffer, sizeof(buffer)) == sizeof(buffer), (label + ": ReadAt size").c_str());
+        Check(std::memcmp(buffer, data.data() + 10, sizeof(buffer)) == 0, (label + ": ReadAt data").c_str());
+        // 複数のスレッドから同じエントリを読み込む
+        std::vector<std::thread> threads;
+        std::vector<int>         errors(4);
+        for (std::size_t t = 0; t < errors.size(); ++t) {
+            threads.emplace_back([&, t] {
+                std::vector<std::byte> chunk(5000);
+                for (std::size_t offset = t * 777; offset < data.size(); offset += 40000) {
+                    auto n = entry->ReadAt(offset, chunk.data(), chunk.size());
+                    auto m = std::min(chunk.size(), data.size() - offset);
+                    if (n != m || std::memcmp(chunk.data(), data.data() + offset, n) != 0) ++errors[t];
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        for (auto error : errors) Check(error == 0, (label + ": concurrent ReadAt").c_str());
+    }
+}
+
+// 書き込み待ちのデータがReadAtで読み込めることを確認する
+void TestPendingReadAt(const std::string& label, SharedStream stream) {
+    auto data = Pattern(1000);
+    Check(stream->Write(data.data(), data.size()) == data.size(), (label + ": Write").c_str());
+    std::byte buffer[100];
+    Check(stream->ReadAt(950, buffer, sizeof(buffer)) == 50, (label + ": ReadAt pending size").c_str());
+    Check(std::memcmp(buffer, data.data() + 950, 50) == 0, (label + ": ReadAt pending data").c_str());
+    Check(stream->Flush(), (label + ": Flush").c_str());
+    Check(stream->ReadAt(0, buffer, sizeof(buffer)) == sizeof(buffer), (label + ": ReadAt flushed size").c_str());
+    Check(std::memcmp(buffer, data.data(), sizeof(buffer)) == 0, (label + ": ReadAt flushed data").c_str());
+}
+
+// キューに渡したデータが元のファイルのバッファに残っていてもReadAtで読み込めることを確認する
+void TestQueuedReadAt(void) {
+    auto path = (std::filesystem::temp_directory_path() / "graphene-test-writebehind.bin").string();
+    {
+        auto data   = Pattern(2500);
+        auto stream = std::make_shared<WriteBehindStream>(FileFactory().Open(path, "w+b"), 1000);
+        Check(stream->Write(data.data(), data.size()) == data.size(), "write-behind file: Write");
+        std::vector<std::byte> buffer(data.size());
+        Check(stream->ReadAt(0, buffer.data(), buffer.size()) == buffer.size(), "write-behind file: ReadAt size");
+        Check(buffer == data, "write-behind file: ReadAt data");
+        // 元のファイルの終端より後ろに書き込んだ場合は間を0で埋める
+        Check(stream->Seek(4000), "write-behind file: Seek");
+        Check(stream->Write(data.data(), 10) == 10, "write-behind file: Write after seek");
+        buffer.assign(1510, std::byte(0xFF));
+        Check(stream->ReadAt(2500, buffer.data(), buffer.size()) == buffer.size(), "write-behind file: ReadAt gap size");
+        Check(std::all_of(buffer.begin(), buffer.begin() + 1500, [](std::byte b) { return b == std::byte(0); }), "write-behind file: ReadAt gap data");
+        Check(std::memcmp(buffer.data() + 1500, data.data(), 10) == 0, "write-behind file: ReadAt tail data");
+    }
+    std::filesystem::remove(path);
+}
+
+// 埋め込んだリソースが名前で開けることを確認する
+void TestBuiltinResources(void) {
+    auto resources = GetBuiltinResources();
+    for (auto name : {"graphics/shader/hlsl/test.vsh", "graphics/shader/hlsl/test.psh"}) {
+        auto stream = resources->Open(name, "r");
+        auto view   = stream->Peek(stream->Size());
+        Check(view.size() && view.size() == stream->Size(), "builtin resources: Open");
+    }
+}
+
+} // namespace
+
+int main(void) {
+    TestNestedReadAt("plain", [](SharedStream s) { return std::make_shared<PlainStream>(s); });
+    TestNestedReadAt("buffered", [](SharedStream s) { return std::make_shared<BufferedStream>(s, 4096); });
+    TestNestedReadAt("buffered plain", [](SharedStream s) {
+        return std::make_shared<BufferedStream>(std::make_shared<PlainStream>(s), 4096);
+    });
+    TestPendingReadAt("buffered", std::make_shared<BufferedStream>(std::make_shared<MemoryStream>(), 4096));
+    TestPendingReadAt("write-behind", std::make_shared<WriteBehindStream>(std::make_shared<MemoryStream>(), 4096));
+    TestQueuedReadAt();
+    TestBuiltinResources();
+    if (Failures) {
+        std::cerr << Failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
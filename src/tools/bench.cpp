@@ -0,0 +1,400 @@
+/** @file
+ * @brief ベンチマークツール
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/graphics/image/atlas.hpp>
+#include <graphene/graphics/image/qoi.hpp>
+#include <graphene/stream/async.hpp>
+#include <graphene/stream/buffered.hpp>
+#include <graphene/stream/file.hpp>
+#include <graphene/stream/mapped.hpp>
+#include <graphene/stream/memory.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../config.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if USE_LIBPNG
+#include <png.h>
+#include <graphene/graphics/image/png.hpp>
+#endif
+
+// 使い方: graphene-bench [ベンチマーク名...]
+// 名前を省略した場合は全てのベンチマークを実行する
+// 結果は1行ごとに「ベンチマーク名 項目 値」の形式で標準出力へ書き出す
+
+namespace {
+
+using namespace Graphene;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int Repeat = 5;
+
+// 最も速かった回の実行時間(秒)を返す
+double Measure(const std::function<void()>& func, int repeat = Repeat) {
+    auto best = 0.0;
+    for (int i = 0; i < repeat; ++i) {
+        auto start   = Clock::now();
+        func();
+        auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        best = i ? std::min(best, seconds) : seconds;
+    }
+    return best;
+}
+
+void Report(const char* bench, const std::string& item, double value, const char* unit) {
+    std::printf("%-8s %-36s %12.3f %s\n", bench, item.c_str(), value, unit);
+}
+
+// ベンチマーク用のRGBA8888画像
+class PatternImage final : public Graphics::Image {
+public:
+    PatternImage(std::size_t width, std::size_t height, std::uint32_t seed) :
+    Width_ (width),
+    Height_(height),
+    Pixels_(width * height * 4) {
+        // グラデーションに矩形のノイズを重ね、実際のテクスチャに近い圧縮率にする
+        std::mt19937 random(seed);
+        for (std::size_t y = 0; y < height; ++y) {
+            for (std::size_t x = 0; x < width; ++x) {
+                auto p = &Pixels_[(y * width + x) * 4];
+                p[0] = std::byte(x * 255 / width);
+                p[1] = std::byte(y * 255 / height);
+                p[2] = std::byte((x ^ y) & 0xC0);
+                p[3] = std::byte(255);
+            }
+        }
+        for (std::size_t i = 0; i < width * height / 4096; ++i) {
+            auto x0 = random() % width, y0 = random() % height;
+            for (auto y = y0; y < std::min(y0 + 16, height); ++y) {
+                for (auto x = x0; x < std::min(x0 + 16, width); ++x) {
+                    auto p = &Pixels_[(y * width + x) * 4];
+                    p[0] = std::byte(random());
+                    p[3] = std::byte(random() & 0x80 ? 255 : random());
+                }
+            }
+        }
+    }
+
+    virtual const void* Data(void) const override { return Pixels_.data(); }
+    virtual std::size_t Size(void) const override { return Pixels_.size(); }
+    virtual std::size_t Rank(void) const override { return 2; }
+    virtual std::size_t Length(std::size_t axis) const override { return axis == 0 ? Width_ : axis == 1 ? Height_ : 1; }
+    virtual std::size_t Stride(void) const override { return Width_ * 4; }
+    virtual Graphics::PixelFormat Format(void) const override { return Graphics::RGBA8888; }
+
+private:
+    std::size_t            Width_;
+    std::size_t            Height_;
+    std::vector<std::byte> Pixels_;
+};
+
+// 一時ディレクトリに作成し、削除時に消えるファイル
+class TempFile final {
+public:
+    TempFile(const std::string& name, std::size_t size) :
+    Path_(std::filesystem::temp_directory_path() / name) {
+        std::mt19937_64 random(size);
+        std::vector<std::uint64_t> chunk(1 << 16);
+        auto stream = Stream::FileFactory().Open(Path_.string(), "w");
+        for (std::size_t written = 0; written < size; written += chunk.size() * 8) {
+            for (auto& value : chunk) value = random();
+            auto n = std::min(chunk.size() * 8, size - written);
+            if (stream->Write(chunk.data(), n) != n) throw std::runtime_error("graphene-bench: Failed to write temporary file.");
+        }
+        stream->Flush();
+#ifndef _WIN32
+        // ページキャッシュから追い出せるように書き込みを完了させる
+        if (auto descriptor = dynamic_cast<Stream::DescriptorStream*>(stream.get())) fsync(descriptor->Descriptor());
+#endif
+    }
+
+    ~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(Path_, ec);
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    std::string Path(void) const {
+        return Path_.string();
+    }
+
+private:
+    std::filesystem::path Path_;
+};
+
+#ifndef _WIN32
+// Readごとにread(2)を1回呼び出すバッファを持たないストリーム
+class RawFileStream final : public Stream::Stream {
+public:
+    explicit RawFileStream(const std::string& path) :
+    Handle_(open(path.c_str(), O_RDONLY)) {
+        if (Handle_ < 0) throw std::runtime_error("graphene-bench: Failed to open file.");
+    }
+
+    virtual ~RawFileStream() override {
+        Close();
+    }
+
+    virtual void Close(void) override {
+        if (Handle_ >= 0) close(Handle_);
+        Handle_ = -1;
+    }
+
+    virtual bool Flush(void) override {
+        return true;
+    }
+
+    virtual std::size_t Read(void* data, std::size_t size) override {
+        auto n = read(Handle_, data, size);
+        return n > 0 ? n : 0;
+    }
+
+    virtual std::size_t Write(const void*, std::size_t) override {
+        return 0;
+    }
+
+    virtual bool Seek(std::size_t offset) override {
+        return lseek(Handle_, offset, SEEK_SET) >= 0;
+    }
+
+    virtual std::size_t Tell(void) const override {
+        auto offset = lseek(Handle_, 0, SEEK_CUR);
+        return offset > 0 ? offset : 0;
+    }
+
+    virtual std::size_t Size(void) const override {
+        struct stat status;
+        return fstat(Handle_, &status) == 0 ? status.st_size : 0;
+    }
+
+private:
+    int Handle_;
+};
+#endif
+
+std::shared_ptr<Stream::MemoryStream> Reopen(const std::vector<std::byte>& data) {
+    return std::make_shared<Stream::MemoryStream>(std::span<const std::byte>(data));
+}
+
+// QOIとPNGのデコード速度の比較
+void BenchImage(void) {
+    for (std::size_t size : {256, 1024, 2048}) {
+        auto image = std::make_shared<PatternImage>(size, size, 1);
+        auto label = std::to_string(size) + "x" + std::to_string(size);
+        auto mb    = image->Size() / 1e6;
+
+        auto qoi = std::make_shared<Stream::MemoryStream>();
+        SaveImageQOI(qoi, image);
+        auto qoiData = std::vector<std::byte>(qoi->Mapping().begin(), qoi->Mapping().end());
+        auto qoiTime = Measure([&] { LoadImageQOI(Reopen(qoiData), Graphics::RGBA8888, false); });
+        Report("image", "qoi " + label + " size", qoiData.size() / 1e3, "KB");
+        Report("image", "qoi " + label + " decode", mb / qoiTime, "MB/s");
+#if USE_LIBPNG
+        png_image png = {};
+        png.version   = PNG_IMAGE_VERSION;
+        png.width     = static_cast<png_uint_32>(size);
+        png.height    = static_cast<png_uint_32>(size);
+        png.format    = PNG_FORMAT_RGBA;
+        png_alloc_size_t length = 0;
+        png_image_write_to_memory(&png, nullptr, &length, 0, image->Data(), 0, nullptr);
+        std::vector<std::byte> pngData(length);
+        if (!png_image_write_to_memory(&png, pngData.data(), &length, 0, image->Data(), 0, nullptr)) {
+            throw std::runtime_error("graphene-bench: Failed to encode png.");
+        }
+        pngData.resize(length);
+        auto pngTime = Measure([&] { LoadImagePNG(Reopen(pngData), Graphics::RGBA8888, false); });
+        Report("image", "png " + label + " size", pngData.size() / 1e3, "KB");
+        Report("image", "png " + label + " decode", mb / pngTime, "MB/s");
+        Report("image", "qoi/png " + label + " speedup", pngTime / qoiTime, "x");
+#endif
+    }
+}
+
+// アトラスの充填率と構築時間(構築は数百ミリ秒以上掛かるため1回のみ計測する)
+void BenchAtlas(void) {
+    struct Case {
+        std::size_t Count;
+        std::size_t MinSize;
+        std::size_t MaxSize;
+    };
+    for (auto& c : {Case{100, 8, 64}, Case{400, 8, 64}, Case{800, 8, 64}, Case{200, 16, 128}, Case{100, 4, 256}}) {
+        std::mt19937 random(c.Count);
+        std::vector<Graphics::SharedImage> sprites;
+        for (std::size_t i = 0; i < c.Count; ++i) {
+            auto width  = c.MinSize + random() % (c.MaxSize - c.MinSize + 1);
+            auto height = c.MinSize + random() % (c.MaxSize - c.MinSize + 1);
+            sprites.push_back(std::make_shared<PatternImage>(width, height, i));
+        }
+        auto label = std::to_string(c.Count) + " sprites " + std::to_string(c.MinSize) + "-" + std::to_string(c.MaxSize) + "px";
+        Graphics::SharedAtlas atlas;
+        auto time = Measure([&] { atlas = BuildImageAtlas(sprites, Graphics::RGBA8888, 8192, 2, 1); }, 1);
+        Report("atlas", label + " build", time * 1e3, "ms");
+        Report("atlas", label + " efficiency", atlas->Efficiency() * 100, "%");
+        Report("atlas", label + " side", static_cast<double>(std::max(atlas->Length(0), atlas->Length(1))), "px");
+    }
+    // 実行時に空のアトラスへ追加する場合
+    std::mt19937 random(0);
+    std::vector<Graphics::SharedImage> sprites;
+    for (std::size_t i = 0; i < 1024; ++i) {
+        sprites.push_back(std::make_shared<PatternImage>(8 + random() % 57, 8 + random() % 57, i));
+    }
+    Graphics::SharedAtlas atlas;
+    auto time = Measure([&] {
+        atlas = Graphics::CreateImageAtlas(Graphics::RGBA8888, 1024, 1024, 2, 1);
+        for (auto& sprite : sprites) {
+            if (!atlas->Insert(sprite)) break;
+        }
+    }, 1);
+    Report("atlas", "insert 1024x1024 until full", time * 1e3, "ms");
+    Report("atlas", "insert 1024x1024 count", static_cast<double>(atlas->Count()), "sprites");
+    Report("atlas", "insert 1024x1024 efficiency", atlas->Efficiency() * 100, "%");
+}
+
+// バッファ付きストリームと元のストリームの小さな読み込みの比較
+void BenchStream(void) {
+    constexpr std::size_t FileSize = 32 << 20;
+    TempFile file("graphene-bench-stream.bin", FileSize);
+    Stream::FileFactory files;
+    Stream::MappedFileFactory mapped;
+    struct Source {
+        const char*                           Name;
+        std::function<Stream::SharedStream()> Open;
+    };
+    const Source sources[] = {
+#ifndef _WIN32
+        {"raw",             [&] { return std::make_shared<RawFileStream>(file.Path()); }},
+        {"raw+buffered",    [&] { return std::make_shared<Stream::BufferedStream>(std::make_shared<RawFileStream>(file.Path())); }},
+#endif
+        {"file",            [&] { return files.Open(file.Path(), "r"); }},
+        {"file+buffered",   [&] { return std::make_shared<Stream::BufferedStream>(files.Open(file.Path(), "r")); }},
+        {"direct",          [&] { return files.Open(file.Path(), "rd"); }},
+        {"direct+buffered", [&] { return std::make_shared<Stream::BufferedStream>(files.Open(file.Path(), "rd")); }},
+        {"mapped",          [&] { return mapped.Open(file.Path(), "r"); }},
+    };
+    // PNGのチャンクのように数バイトのヘッダとCRCの間に可変長のデータが続く読み込み
+    auto chunks = [](Stream::SharedStream stream) {
+        std::byte header[8], crc[4];
+        std::vector<std::byte> payload(4096);
+        std::uint32_t state = 1;
+        while (stream->Read(header, sizeof(header)) == sizeof(header)) {
+            state = state * 1664525 + 1013904223;
+            stream->Read(payload.data(), 16 + (state >> 8) % (payload.size() - 16));
+            stream->Read(crc, sizeof(crc));
+        }
+    };
+    // 4バイトずつの読み込み
+    auto words = [](Stream::SharedStream stream) {
+        std::uint32_t word;
+        while (stream->Read(&word, sizeof(word)) == sizeof(word)) {
+        }
+    };
+    for (auto& source : sources) {
+        auto mb = FileSize / 1e6;
+        Report("stream", std::string(source.Name) + " chunk reads", mb / Measure([&] { chunks(source.Open()); }), "MB/s");
+        Report("stream", std::string(source.Name) + " 4-byte reads", mb / Measure([&] { words(source.Open()); }, 1), "MB/s");
+    }
+}
+
+// アクセスのヒントによるページキャッシュが空の状態からの読み込み速度の比較
+// (tmpfsなどページキャッシュを追い出せないファイルシステムでは差が出ない)
+void BenchFadvise(void) {
+    constexpr std::size_t FileSize = 64 << 20;
+    TempFile file("graphene-bench-fadvise.bin", FileSize);
+    Stream::FileFactory files;
+    auto open = [&](Stream::AccessHint hint) {
+        auto stream = files.Open(file.Path(), "r");
+        if (!stream->Advise(Stream::AccessHintDontNeed)) throw std::runtime_error("graphene-bench: Failed to evict page cache.");
+        stream->Advise(hint);
+        return stream;
+    };
+    // 64KiBずつ先頭から読み込む
+    auto sequential = [&](Stream::AccessHint hint) {
+        auto stream = open(hint);
+        std::vector<std::byte> buffer(64 << 10);
+        return Measure([&] { while (stream->Read(buffer.data(), buffer.size()) == buffer.size()) {} }, 1);
+    };
+    // 4KiBずつランダムな位置から読み込む
+    auto random = [&](Stream::AccessHint hint) {
+        auto stream = open(hint);
+        std::vector<std::byte> buffer(4 << 10);
+        std::mt19937_64 engine(0);
+        return Measure([&] {
+            for (int i = 0; i < 4096; ++i) {
+                stream->ReadAt(engine() % (FileSize / buffer.size()) * buffer.size(), buffer.data(), buffer.size());
+            }
+        }, 1);
+    };
+    const std::pair<const char*, Stream::AccessHint> hints[] = {
+        {"normal",     Stream::AccessHintNormal},
+        {"sequential", Stream::AccessHintSequential},
+        {"random",     Stream::AccessHintRandom},
+        {"willneed",   Stream::AccessHintWillNeed},
+    };
+    for (auto& [name, hint] : hints) {
+        Report("fadvise", std::string("cold sequential ") + name, FileSize / 1e6 / sequential(hint), "MB/s");
+    }
+    for (auto& [name, hint] : hints) {
+        Report("fadvise", std::string("cold random 4KiB ") + name, random(hint) * 1e6 / 4096, "us/read");
+    }
+}
+
+struct Bench {
+    const char* Name;
+    void      (*Run)(void);
+};
+
+const Bench Benches[] = {
+    {"image", BenchImage},
+    {"atlas", BenchAtlas},
+    {"stream", BenchStream},
+    {"fadvise", BenchFadvise},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto program = argv[0];
+    std::vector<std::string> names(argv + 1, argv + argc);
+    try {
+        for (auto& name : names) {
+            if (std::none_of(std::begin(Benches), std::end(Benches), [&](const Bench& b) { return name == b.Name; })) {
+                std::cerr << "usage: " << program << " [";
+                for (auto& bench : Benches) std::cerr << (&bench == Benches ? "" : "|") << bench.Name;
+                std::cerr << "]..." << std::endl;
+                return 2;
+            }
+        }
+        for (auto& bench : Benches) {
+            if (names.empty() || std::find(names.begin(), names.end(), bench.Name) != names.end()) bench.Run();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << program << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
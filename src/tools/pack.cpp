@@ -0,0 +1,42 @@
+/** @file
+ * @brief アーカイブ作成ツール
+ * @author Takaaki Sato
+ * @copyright (c) 2022 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#include <graphene/stream/archive.hpp>
+#include <graphene/stream/file.hpp>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// 使い方: graphene-pack [-z] <入力ディレクトリ> <出力ファイル>
+// ディレクトリ以下の全ファイルを、ディレクトリからの相対パス('/'区切り)を名前として格納する
+// -zを指定した場合は各ファイルを圧縮して格納する
+int main(int argc, char* argv[]) {
+    auto program  = argv[0];
+    auto compress = argc == 4 && std::string(argv[1]) == "-z";
+    if (argc != 3 && !compress) {
+        std::cerr << "usage: " << program << " [-z] <directory> <archive>" << std::endl;
+        return 2;
+    }
+    argv += compress;
+    try {
+        namespace fs = std::filesystem;
+        fs::path root(argv[1]);
+        std::vector<Graphene::Stream::ArchiveEntry> entries;
+        for (auto& file : fs::recursive_directory_iterator(root)) {
+            if (!file.is_regular_file()) continue;
+            entries.push_back({fs::relative(file.path(), root).generic_string(), file.path().string(), compress});
+        }
+        auto factory = std::make_shared<Graphene::Stream::FileFactory>();
+        Graphene::Stream::SaveArchive(factory->Open(argv[2], "w"), factory, entries);
+        std::cout << entries.size() << " entries written to " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << program << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+/** @file
+ * @brief バージョン情報
+ * @author Takaaki Sato
+ * @copyright (c) 2021 Demiquartz &lt;info@demiquartz.jp&gt; @n
+ * Distributed under the MIT License (See accompanying file LICENSE
+ * or copy at https://opensource.org/licenses/MIT)
+ */
+#ifndef GRAPHENE_VERSION_HPP
+#define GRAPHENE_VERSION_HPP
+
+/// システム名
+#define SYSNAME  "graphene"
+/// バージョン文字列
+#define VERSION  "0.0.0"
+/// リビジョン文字列
+#define REVISION "0.0.0-0-g0000000"
+
+/// メジャーバージョン番号
+#define VERSION_MAJOR 0
+/// マイナーバージョン番号
+#define VERSION_MINOR 0
+/// パッチバージョン番号
+#define VERSION_PATCH 0
+
+#endif // GRAPHENE_VERSION_HPP